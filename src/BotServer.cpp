@@ -0,0 +1,708 @@
+// BotServer.cpp
+#include "BotServer.hpp"
+#include "SignalHandler.hpp"
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+
+// Déclaration des variables globales utilisées
+extern volatile sig_atomic_t should_exit;
+extern double botDebit;
+extern double botRafale;
+extern RateLimiter::Politique botPolitique;
+extern size_t botCache;
+extern volatile sig_atomic_t flush_demande;
+
+// Fonction utilisée
+extern double maintenant();
+
+// Événements qui modifient la liste des fichiers d'un dossier
+static constexpr uint32_t CHANGEMENT_NOMS = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+// Événements qui modifient le contenu ou les droits d'un fichier
+static constexpr uint32_t CHANGEMENT_CONTENU = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE;
+
+/**
+ * @brief Filtre de scandir : comme ls, les fichiers cachés ne sont pas listés
+ */
+static int nonCache(const struct dirent* entree) {
+    return entree->d_name[0] != '.';
+}
+
+/**
+ * @brief Lit le début d'un fichier
+ * @param chemin Chemin du fichier
+ * @param limite Octets lus au plus (le reste ne pourrait pas être envoyé)
+ * @return Contenu lu, vide si le fichier est illisible
+ */
+static std::string lireFichier(const std::string& chemin, size_t limite) {
+    std::string contenu;
+    int fd = open(chemin.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return contenu;
+    }
+    char buffer[4096];
+    ssize_t n;
+    while (contenu.size() < limite
+           && (n = read(fd, buffer, std::min(sizeof(buffer), limite - contenu.size()))) != 0) {
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        contenu.append(buffer, n);
+    }
+    close(fd);
+    return contenu;
+}
+
+/**
+ * @brief Réponse à "liste", comme echo "$(ls)" dans chat-bot
+ */
+static std::string listerFichiers() {
+    struct dirent** entrees;
+    int n = scandir(".", &entrees, nonCache, alphasort);
+    std::string liste;
+    for (int i = 0; i < n; ++i) {
+        if (i > 0) liste += "\n";
+        liste += entrees[i]->d_name;
+        free(entrees[i]);
+    }
+    if (n > 0) free(entrees);
+    return liste + "\n";
+}
+
+/**
+ * @brief Réponse à "li fichier", comme dans chat-bot
+ * @param fichier Chemin du fichier demandé
+ */
+static std::string lectureFichier(const std::string& fichier) {
+    struct stat st;
+    if (stat(fichier.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+        return lireFichier(fichier, BotServer::TAILLE_SORTIE_MAX) + "\n";
+    }
+    return "Erreur : fichier '" + fichier + "' introuvable.\n";
+}
+
+/**
+ * @brief Surveillances dont dépend la réponse à "li fichier"
+ * Chaque dossier du chemin est surveillé pour l'entrée suivante : renommer ou
+ * remplacer un dossier parent change aussi le fichier désigné. Un dossier
+ * intermédiaire qui est un lien dépend de dossiers hors du chemin.
+ * @param fichier Chemin du fichier demandé
+ * @param surveillances Surveillances à poser
+ * @return false si la réponse ne peut pas être mise en cache
+ */
+static bool surveillancesLecture(const std::string& fichier, std::vector<ResultCache::Surveillance>& surveillances) {
+    std::string dossier = fichier.compare(0, 1, "/") == 0 ? "/" : ".";
+    size_t debut = 0;
+    size_t barre;
+    while ((barre = fichier.find('/', debut)) != std::string::npos) {
+        if (barre > debut) {
+            std::string chemin = fichier.substr(0, barre);
+            struct stat st;
+            if (lstat(chemin.c_str(), &st) == 0 && S_ISLNK(st.st_mode)) {
+                return false;
+            }
+            surveillances.push_back({dossier, fichier.substr(debut, barre - debut), CHANGEMENT_NOMS | IN_ATTRIB});
+            dossier = chemin;
+        }
+        debut = barre + 1;
+    }
+    std::string nom = fichier.substr(debut);
+    if (nom.empty()) return false;
+
+    // L'entrée du dossier (création, suppression, remplacement, y compris
+    // de la réponse "introuvable") et le fichier lui-même, cible d'un lien comprise
+    surveillances.push_back({dossier, nom, CHANGEMENT_NOMS | CHANGEMENT_CONTENU});
+    struct stat st;
+    if (stat(fichier.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+        surveillances.push_back({fichier, "", CHANGEMENT_CONTENU});
+    }
+    return true;
+}
+
+/**
+ * @brief Constructeur de la classe BotServer
+ * @param pseudo Pseudonyme du bot
+ */
+BotServer::BotServer(const std::string& pseudo) : pseudo(pseudo), cache(botCache) {
+}
+
+/**
+ * @brief Destructeur : ferme les descripteurs du serveur
+ */
+BotServer::~BotServer() {
+    if (fd_inotify != -1) ::close(fd_inotify);
+    if (fd_epoll != -1) ::close(fd_epoll);
+}
+
+/**
+ * @brief Construit le chemin d'un pipe nommé
+ * @param de Pseudonyme de l'expéditeur
+ * @param vers Pseudonyme du destinataire
+ * @param extension "chat" pour les données, "ctrl" pour le contrôle
+ */
+std::string BotServer::pipePath(const std::string& de, const std::string& vers, const char* extension) const {
+    return std::string(DOSSIER_PIPES) + "/" + de + "-" + vers + "." + extension;
+}
+
+/**
+ * @brief Charge liste-bot.txt une seule fois pour toutes les sessions
+ */
+void BotServer::loadDictionary() {
+    FILE* fichier = fopen(FICHIER_DICTIONNAIRE, "r");
+    if (!fichier) {
+        perror("Erreur lors de l'ouverture de liste-bot.txt");
+        return;
+    }
+    char* ligne = nullptr;
+    size_t taille = 0;
+    ssize_t n;
+    while ((n = getline(&ligne, &taille, fichier)) != -1) {
+        std::string entree(ligne, n);
+        if (!entree.empty() && entree.back() == '\n') {
+            entree.pop_back();
+        }
+        size_t espace = entree.find(' ');
+        if (espace == std::string::npos) {
+            continue; // Sans espace, la ligne ne peut correspondre à aucune commande
+        }
+        dictionnaire[entree.substr(0, espace)].push_back(entree);
+    }
+    free(ligne);
+    fclose(fichier);
+}
+
+/**
+ * @brief Cherche la réponse à une commande dans le dictionnaire
+ * Comme `grep -m 1 "^commande "` dans chat-bot, mais la commande est
+ * comparée telle quelle et non comme une expression régulière.
+ * @param commande Commande reçue
+ * @return Texte qui suit le premier espace de la ligne trouvée, "🤖 ?" sinon
+ */
+std::string BotServer::lookup(const std::string& commande) const {
+    auto it = dictionnaire.find(commande.substr(0, commande.find(' ')));
+    if (it != dictionnaire.end()) {
+        std::string prefixe = commande + " ";
+        for (const std::string& ligne : it->second) {
+            if (ligne.compare(0, prefixe.size(), prefixe) == 0) {
+                std::string reponse = ligne.substr(ligne.find(' ') + 1);
+                if (!reponse.empty()) return reponse;
+                break; // Seule la première ligne trouvée compte
+            }
+        }
+    }
+    return "🤖 ?";
+}
+
+/**
+ * @brief Parcourt le dossier des pipes à la recherche de nouvelles sessions
+ * Rattrape les créations manquées par inotify (file pleine, serveur lancé après les clients).
+ */
+void BotServer::scanDirectory() {
+    DIR* dossier = opendir(DOSSIER_PIPES);
+    if (!dossier) {
+        perror("Erreur lors du parcours du dossier des pipes");
+        return;
+    }
+    while (struct dirent* entree = readdir(dossier)) {
+        discover(entree->d_name);
+    }
+    closedir(dossier);
+
+    // Oublier les fermetures suffisamment anciennes
+    double t = maintenant();
+    for (auto it = fermetures.begin(); it != fermetures.end();) {
+        if (t - it->second >= DELAI_RECONNEXION) it = fermetures.erase(it);
+        else ++it;
+    }
+}
+
+/**
+ * @brief Traite les créations de fichiers signalées par inotify
+ */
+void BotServer::readInotify() {
+    alignas(struct inotify_event) char evenements[4096];
+    ssize_t n;
+    while ((n = read(fd_inotify, evenements, sizeof(evenements))) > 0) {
+        for (char* p = evenements; p < evenements + n;) {
+            struct inotify_event* evenement = reinterpret_cast<struct inotify_event*>(p);
+            if (evenement->mask & IN_Q_OVERFLOW) {
+                scanDirectory(); // Des créations ont été perdues
+            } else if (evenement->len > 0) {
+                discover(evenement->name);
+            }
+            p += sizeof(struct inotify_event) + evenement->len;
+        }
+    }
+}
+
+/**
+ * @brief Crée une session si le fichier est le pipe d'envoi d'un utilisateur vers le bot
+ * @param nomPipe Nom du fichier dans le dossier des pipes
+ */
+void BotServer::discover(const std::string& nomPipe) {
+    std::string suffixe = "-" + pseudo + ".chat";
+    if (nomPipe.size() <= suffixe.size() ||
+        nomPipe.compare(nomPipe.size() - suffixe.size(), suffixe.size(), suffixe) != 0) {
+        return;
+    }
+    std::string autre = nomPipe.substr(0, nomPipe.size() - suffixe.size());
+
+    // Mêmes règles que pour les pseudonymes en ligne de commande
+    if (autre.size() > 30 || autre == "." || autre == ".." || autre == pseudo ||
+        autre.find_first_of("/[]-") != std::string::npos) {
+        return;
+    }
+    if (sessions.count(autre)) {
+        return;
+    }
+    auto fermeture = fermetures.find(autre);
+    if (fermeture != fermetures.end() && maintenant() - fermeture->second < DELAI_RECONNEXION) {
+        return; // Laisser l'utilisateur qui vient de partir supprimer ses pipes
+    }
+    SessionRegistry::Session existante;
+    if (registry.find(pseudo, autre, existante) && existante.vivante && existante.pid != getpid()) {
+        return; // Utilisateur déjà servi par un autre processus (chat-bot)
+    }
+
+    std::unique_ptr<Session> session(new Session(autre, botDebit, botRafale, botPolitique));
+    session->creation = maintenant();
+    session->slot = registry.add(pseudo, autre, getpid(), SessionRegistry::MODE_BOT);
+    sessions.emplace(autre, std::move(session));
+}
+
+/**
+ * @brief Ajoute un descripteur de la session à l'instance epoll
+ * @param evenements Événements surveillés
+ */
+void BotServer::watch(Session& s, int fd, uint32_t evenements) {
+    struct epoll_event evenement = {};
+    evenement.events = evenements;
+    evenement.data.fd = fd;
+    if (epoll_ctl(fd_epoll, EPOLL_CTL_ADD, fd, &evenement) == -1) {
+        perror("Erreur lors de l'ajout d'un pipe à epoll");
+    }
+    parDescripteur[fd] = &s;
+}
+
+/**
+ * @brief Poursuit l'ouverture des pipes d'une session, sans jamais bloquer
+ * Les ouvertures suivent l'ordre du client : pipes de données, puis de contrôle.
+ */
+void BotServer::openSession(Session& s) {
+    if (s.etat == Etat::ATTENTE) {
+        s.fd_send = open(pipePath(pseudo, s.pseudo, "chat").c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (s.fd_send == -1) {
+            // Pipe de réception de l'autre utilisateur pas encore créé ou pas encore
+            // ouvert : réessayer tant que son pipe d'envoi existe
+            bool enCreation = errno == ENOENT && access(pipePath(s.pseudo, pseudo, "chat").c_str(), F_OK) == 0;
+            if (errno == ENXIO || enCreation) {
+                retryOpen(s);
+            } else {
+                closeSession(s, false); // Pipes supprimés entre-temps
+            }
+            return;
+        }
+        struct stat st;
+        if (fstat(s.fd_send, &st) == -1 || !S_ISFIFO(st.st_mode)) {
+            closeSession(s, false);
+            return;
+        }
+        // Débloque l'ouverture des pipes d'envoi du client
+        s.fd_receive = open(pipePath(s.pseudo, pseudo, "chat").c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        s.fd_ctrl_receive = open(pipePath(s.pseudo, pseudo, "ctrl").c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (s.fd_receive == -1 || s.fd_ctrl_receive == -1) {
+            closeSession(s, false);
+            return;
+        }
+        s.etat = Etat::CONNEXION;
+    }
+
+    s.fd_ctrl_send = open(pipePath(pseudo, s.pseudo, "ctrl").c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (s.fd_ctrl_send == -1) {
+        if (errno == ENXIO) {
+            retryOpen(s);
+        } else {
+            closeSession(s, false);
+        }
+        return;
+    }
+
+    s.etat = Etat::ACTIVE;
+    watch(s, s.fd_ctrl_receive, EPOLLIN);
+    watch(s, s.fd_receive, EPOLLIN);
+    watch(s, s.fd_send, 0); // EPOLLERR quand l'autre utilisateur ferme son pipe de réception
+    printf("Session ouverte avec %s\n", s.pseudo.c_str());
+    fflush(stdout);
+}
+
+/**
+ * @brief Programme une nouvelle tentative d'ouverture, tant que l'autre utilisateur existe
+ * Son entrée du registre doit être vivante ; sans entrée (pas encore inscrit, ou
+ * registre indisponible), il a DELAI_CONNEXION secondes pour ouvrir ses pipes.
+ * Sinon les pipes ont été laissés par un client disparu : ils sont supprimés.
+ */
+void BotServer::retryOpen(Session& s) {
+    SessionRegistry::Session autre;
+    bool present = registry.find(s.pseudo, pseudo, autre)
+        ? autre.vivante
+        : maintenant() - s.creation < DELAI_CONNEXION;
+    if (!present) {
+        closeSession(s, true);
+        return;
+    }
+    s.prochainEssai = maintenant() + INTERVALLE_CONNEXION_MS / 1000.0;
+}
+
+/**
+ * @brief Ferme une session ; l'objet est supprimé à la fin du tour de boucle
+ * @param supprimerPipes Supprimer les pipes nommés, comme le ferait chat-bot
+ */
+void BotServer::closeSession(Session& s, bool supprimerPipes) {
+    if (s.fermee) return;
+    s.fermee = true;
+
+    if (s.etat == Etat::ACTIVE) {
+        flushOutput(s);
+        // Prévenir l'autre utilisateur sans attendre qu'il ait lu nos messages
+        Pipes::sendControl(s.fd_ctrl_send, TypeControle::DISCONNECT);
+        printf("Session fermée avec %s\n", s.pseudo.c_str());
+        fflush(stdout);
+        if (s.limiteur.occupees + s.limiteur.ignorees + s.limiteur.fusionnees > 0) {
+            fprintf(stderr, "%s : ", s.pseudo.c_str());
+            s.limiteur.print_stats(stderr);
+        }
+    }
+
+    for (int* fd : {&s.fd_receive, &s.fd_send, &s.fd_ctrl_receive, &s.fd_ctrl_send}) {
+        if (*fd == -1) continue;
+        parDescripteur.erase(*fd);
+        ::close(*fd); // Retire aussi le descripteur de l'instance epoll
+        *fd = -1;
+    }
+
+    registry.remove(s.slot, getpid());
+    s.slot = -1;
+    fermetures[s.pseudo] = maintenant();
+
+    if (supprimerPipes) {
+        unlink(pipePath(pseudo, s.pseudo, "chat").c_str());
+        unlink(pipePath(s.pseudo, pseudo, "chat").c_str());
+        unlink(pipePath(pseudo, s.pseudo, "ctrl").c_str());
+        unlink(pipePath(s.pseudo, pseudo, "ctrl").c_str());
+    }
+}
+
+/**
+ * @brief Traite une trame reçue sur le canal de contrôle d'une session
+ */
+void BotServer::handleControl(Session& s) {
+    TrameControle trame;
+    ssize_t n = Pipes::readControl(s.fd_ctrl_receive, trame);
+    if (n == -1 && errno == EAGAIN) return;
+
+    if (n <= 0 || trame.type == TypeControle::DISCONNECT) {
+        // L'autre utilisateur a quitté : répondre aux messages qu'il a envoyés
+        // avant de partir, la session se ferme sur la fin de flux des données
+        parDescripteur.erase(s.fd_ctrl_receive);
+        ::close(s.fd_ctrl_receive);
+        s.fd_ctrl_receive = -1;
+    }
+    // HEARTBEAT ou type inconnu : la trame prouve seulement que l'autre est vivant
+}
+
+/**
+ * @brief Lit les messages disponibles sur le pipe de données d'une session
+ */
+void BotServer::handleData(Session& s) {
+    ssize_t n = read(s.fd_receive, tampon, sizeof(tampon));
+    if (n == -1) {
+        if (errno == EINTR || errno == EAGAIN) return;
+        perror("Erreur lors de la lecture du pipe de réception");
+        closeSession(s, false);
+        return;
+    }
+    if (n == 0) {
+        closeSession(s, false); // Pipe fermé, l'autre utilisateur a quitté
+        return;
+    }
+
+    for (ssize_t debut = 0; debut < n && !s.fermee;) {
+        const char* fin = static_cast<const char*>(memchr(tampon + debut, '\0', n - debut));
+        size_t longueur = fin ? fin - (tampon + debut) : n - debut;
+        // Comme le buffer du client, un message est limité à TAILLE_MESSAGE octets
+        size_t place = TAILLE_MESSAGE - 1 - std::min(s.partiel.size(), TAILLE_MESSAGE - 1);
+        s.partiel.append(tampon + debut, std::min(longueur, place));
+        if (!fin) break; // Suite du message au prochain read
+
+        std::string requete;
+        requete.swap(s.partiel);
+        handleRequest(s, requete);
+        debut += longueur + 1;
+    }
+}
+
+/**
+ * @brief Soumet une requête au limiteur de la session
+ */
+void BotServer::handleRequest(Session& s, const std::string& requete) {
+    switch (s.limiteur.submit(requete)) {
+        case RateLimiter::Decision::ACCEPTEE:
+            answerRequest(s, requete);
+            s.occupeSignale = false;
+            break;
+        case RateLimiter::Decision::OCCUPEE:
+            if (!s.occupeSignale) {
+                sendReply(s, RateLimiter::MESSAGE_OCCUPE);
+                s.occupeSignale = true;
+            }
+            break;
+        default:
+            break; // En file, ignorée ou fusionnée
+    }
+}
+
+/**
+ * @brief Exécute une commande, avec les mêmes réponses que le script chat-bot
+ * @param requete Message reçu
+ */
+void BotServer::answerRequest(Session& s, const std::string& requete) {
+    // Les blancs de fin de ligne sont retirés, comme par `read`
+    std::string commande = requete;
+    size_t fin = commande.find_last_not_of(" \t\n");
+    commande.erase(fin == std::string::npos ? 0 : fin + 1);
+
+    if (commande == "liste") {
+        std::string liste;
+        if (!cache.find(commande, liste)) {
+            // Seuls les noms du dossier comptent, pas le contenu des fichiers
+            bool enCache = cache.reserve(commande, {{".", "", CHANGEMENT_NOMS}});
+            liste = listerFichiers();
+            if (enCache) cache.insert(commande, liste);
+        }
+        sendReply(s, liste);
+    } else if (commande == "qui suis-je") {
+        sendReply(s, s.pseudo + "\n");
+    } else if (commande == "au revoir") {
+        closeSession(s, true);
+    } else if (commande.rfind("li ", 0) == 0) {
+        std::string reponse;
+        if (!cache.find(commande, reponse)) {
+            std::string fichier = commande.substr(3);
+            std::vector<ResultCache::Surveillance> surveillances;
+            bool enCache = surveillancesLecture(fichier, surveillances) && cache.reserve(commande, surveillances);
+            reponse = lectureFichier(fichier);
+            if (enCache) cache.insert(commande, reponse);
+        }
+        sendReply(s, reponse);
+    } else {
+        sendReply(s, lookup(commande) + "\n");
+    }
+}
+
+/**
+ * @brief Découpe une réponse en messages et les envoie
+ * Le découpage est celui de fgets dans chat --bot : un message par ligne,
+ * d'au plus TAILLE_MESSAGE - 1 octets.
+ * @param reponse Texte de la réponse
+ */
+void BotServer::sendReply(Session& s, const std::string& reponse) {
+    if (s.fermee) return;
+    for (size_t debut = 0; debut < reponse.size() && s.sortie.size() < TAILLE_SORTIE_MAX;) {
+        // Fin de ligne cherchée seulement dans la longueur d'un message
+        const char* message = reponse.data() + debut;
+        size_t longueur = std::min(reponse.size() - debut, TAILLE_MESSAGE - 1);
+        const char* fin = static_cast<const char*>(memchr(message, '\n', longueur));
+        if (fin) longueur = fin - message + 1;
+        // Comme strlen côté client, le message s'arrête au premier '\0'
+        s.sortie.append(message, strnlen(message, longueur));
+        s.sortie += '\0';
+        debut += longueur;
+    }
+    flushOutput(s);
+}
+
+/**
+ * @brief Écrit les messages en attente sans bloquer ; le reste sera écrit
+ * quand epoll signalera de la place dans le pipe
+ */
+void BotServer::flushOutput(Session& s) {
+    if (s.fd_send == -1) return;
+    size_t ecrit = 0;
+    while (ecrit < s.sortie.size()) {
+        ssize_t n = write(s.fd_send, s.sortie.data() + ecrit, s.sortie.size() - ecrit);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) break;
+            s.sortie.clear();
+            closeSession(s, false); // L'autre utilisateur a fermé son pipe de réception
+            return;
+        }
+        ecrit += n;
+    }
+    s.sortie.erase(0, ecrit);
+
+    bool attente = !s.sortie.empty();
+    if (attente != s.attenteEcriture) {
+        struct epoll_event evenement = {};
+        evenement.events = attente ? static_cast<uint32_t>(EPOLLOUT) : 0;
+        evenement.data.fd = s.fd_send;
+        epoll_ctl(fd_epoll, EPOLL_CTL_MOD, s.fd_send, &evenement);
+        s.attenteEcriture = attente;
+    }
+}
+
+/**
+ * @brief Boucle principale du serveur : toutes les sessions dans un seul processus
+ * @return Code de retour du programme
+ */
+int BotServer::run() {
+    signal(SIGINT, SignalHandler::handleSIGTERM);  // Arrêt propre, comme pour SIGTERM
+    signal(SIGTERM, SignalHandler::handleSIGTERM);
+    signal(SIGPIPE, SIG_IGN); // Utilisateur déjà parti : l'écriture échoue avec EPIPE
+    signal(SIGUSR1, SignalHandler::handleSIGUSR1); // Affichage des compteurs du cache
+
+    fd_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (fd_epoll == -1) {
+        perror("Erreur lors de la création de l'instance epoll");
+        return 1;
+    }
+
+    loadDictionary();
+    registry.open(); // Facultatif : sans registre, chat --who ne voit pas les sessions
+
+    fd_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_inotify != -1 &&
+        inotify_add_watch(fd_inotify, DOSSIER_PIPES, IN_CREATE | IN_MOVED_TO | IN_ONLYDIR) == -1) {
+        ::close(fd_inotify);
+        fd_inotify = -1;
+    }
+    if (fd_inotify != -1) {
+        struct epoll_event evenement = {};
+        evenement.events = EPOLLIN;
+        evenement.data.fd = fd_inotify;
+        epoll_ctl(fd_epoll, EPOLL_CTL_ADD, fd_inotify, &evenement);
+    } else {
+        fprintf(stderr, "\033[33mWARNING\033[0m inotify indisponible, nouvelles sessions détectées toutes les %d s.\n",
+                INTERVALLE_BALAYAGE);
+    }
+
+    if (botCache > 0 && !cache.open()) {
+        fprintf(stderr, "\033[33mWARNING\033[0m inotify indisponible, résultats non mis en cache.\n");
+    }
+    if (cache.fd() != -1) {
+        // Invalidations appliquées au fil de l'eau, même sans requête
+        struct epoll_event evenement = {};
+        evenement.events = EPOLLIN;
+        evenement.data.fd = cache.fd();
+        epoll_ctl(fd_epoll, EPOLL_CTL_ADD, cache.fd(), &evenement);
+    }
+
+    printf("Bot %s en attente de connexions...\n", pseudo.c_str());
+    fflush(stdout);
+
+    double prochainBalayage = 0;
+    double prochainHeartbeat = maintenant() + SessionRegistry::INTERVALLE_HEARTBEAT;
+    struct epoll_event evenements[64];
+    while (!should_exit) {
+        if (flush_demande) {
+            flush_demande = 0;
+            cache.print_stats(stderr);
+        }
+        double t = maintenant();
+        if (t >= prochainBalayage) {
+            scanDirectory();
+            prochainBalayage = t + INTERVALLE_BALAYAGE;
+        }
+        if (t >= prochainHeartbeat) {
+            for (auto& entree : sessions) {
+                Session& s = *entree.second;
+                registry.heartbeat(s.slot, getpid());
+                if (s.etat == Etat::ACTIVE) {
+                    Pipes::sendControl(s.fd_ctrl_send, TypeControle::HEARTBEAT);
+                }
+            }
+            prochainHeartbeat = t + SessionRegistry::INTERVALLE_HEARTBEAT;
+        }
+
+        // Ouvertures en cours et requêtes en file pour lesquelles un jeton est disponible
+        int delai = static_cast<int>((std::min(prochainBalayage, prochainHeartbeat) - t) * 1000) + 1;
+        for (auto& entree : sessions) {
+            Session& s = *entree.second;
+            if (s.etat != Etat::ACTIVE) {
+                if (t >= s.prochainEssai) openSession(s);
+                if (s.etat != Etat::ACTIVE && !s.fermee) delai = std::min(delai, INTERVALLE_CONNEXION_MS);
+                continue;
+            }
+            std::string requete;
+            while (!s.fermee && s.limiteur.nextReady(requete)) {
+                answerRequest(s, requete);
+                s.occupeSignale = false;
+            }
+            int attente = s.fermee ? -1 : s.limiteur.pollTimeout();
+            if (attente >= 0) delai = std::min(delai, attente);
+        }
+
+        int n = epoll_wait(fd_epoll, evenements, 64, std::max(delai, 0));
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("Erreur lors de l'attente sur les pipes");
+            break;
+        }
+
+        // Le canal de contrôle est traité avant les données, comme dans chat
+        for (int passe = 0; passe < 2; ++passe) {
+            for (int i = 0; i < n; ++i) {
+                int fd = evenements[i].data.fd;
+                if (fd == fd_inotify) {
+                    if (passe == 0) readInotify();
+                    continue;
+                }
+                if (fd == cache.fd()) {
+                    if (passe == 0) cache.readEvents();
+                    continue;
+                }
+                auto it = parDescripteur.find(fd);
+                if (it == parDescripteur.end()) continue; // Session fermée entre-temps
+                Session& s = *it->second;
+                bool controle = fd == s.fd_ctrl_receive;
+                if (controle != (passe == 0)) continue;
+
+                if (controle) {
+                    handleControl(s);
+                } else if (fd == s.fd_receive) {
+                    handleData(s);
+                } else if (evenements[i].events & EPOLLERR) {
+                    closeSession(s, false); // L'autre utilisateur a fermé son pipe de réception
+                } else {
+                    flushOutput(s);
+                }
+            }
+        }
+
+        // Suppression des sessions fermées pendant ce tour
+        for (auto it = sessions.begin(); it != sessions.end();) {
+            if (it->second->fermee) it = sessions.erase(it);
+            else ++it;
+        }
+    }
+
+    // Prévenir tous les utilisateurs connectés
+    for (auto& entree : sessions) {
+        closeSession(*entree.second, false);
+    }
+    sessions.clear();
+    if (cache.succes + cache.echecs > 0) {
+        cache.print_stats(stderr);
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+// BotServer.hpp
+#ifndef BOTSERVER_HPP
+#define BOTSERVER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "Pipes.hpp"
+#include "RateLimiter.hpp"
+#include "ResultCache.hpp"
+#include "SessionRegistry.hpp"
+
+class BotServer {
+public:
+    // Constantes
+    static constexpr const char* DOSSIER_PIPES = "/tmp";             // Emplacement des pipes nommés
+    static constexpr const char* FICHIER_DICTIONNAIRE = "liste-bot.txt";
+    static constexpr size_t TAILLE_MESSAGE = 256;      // Buffer de fgets du client (et du bot en bash)
+    static constexpr size_t TAILLE_SORTIE_MAX = 1 << 20; // Réponses en attente d'envoi, par session
+    static constexpr int INTERVALLE_CONNEXION_MS = 100; // Entre deux tentatives d'ouverture des pipes
+    static constexpr int INTERVALLE_BALAYAGE = 2;      // Secondes entre deux parcours du dossier des pipes
+    static constexpr int DELAI_RECONNEXION = 2;        // Secondes avant de rouvrir une session fermée
+    static constexpr int DELAI_CONNEXION = 5;          // Secondes d'attente d'un utilisateur absent du registre
+
+    // Constructeur et destructeur
+    BotServer(const std::string& pseudo);
+    ~BotServer();
+
+    // Fonction
+    int run();
+
+private:
+    // Étapes de l'ouverture d'une session
+    enum class Etat {
+        ATTENTE,                     // Pipes créés, en attente du lecteur de l'autre utilisateur
+        CONNEXION,                   // Pipes de données ouverts, en attente du canal de contrôle
+        ACTIVE,
+    };
+
+    struct Session {
+        std::string pseudo;          // Pseudonyme de l'autre utilisateur
+        Etat etat = Etat::ATTENTE;
+        int fd_receive = -1;         // Descripteur du pipe de réception
+        int fd_send = -1;            // Descripteur du pipe d'envoi
+        int fd_ctrl_receive = -1;    // Descripteur du pipe de contrôle de réception
+        int fd_ctrl_send = -1;       // Descripteur du pipe de contrôle d'envoi
+        std::string partiel;         // Message reçu pas encore terminé par '\0'
+        std::string sortie;          // Messages en attente d'envoi, terminés par '\0'
+        bool attenteEcriture = false; // Pipe d'envoi surveillé en écriture
+        bool occupeSignale = false;  // Une seule réponse "occupé" par période de surcharge
+        bool fermee = false;         // À supprimer à la fin du tour de boucle
+        double prochainEssai = 0;    // Instant de la prochaine tentative d'ouverture
+        double creation = 0;         // Instant de la découverte des pipes
+        long slot = -1;              // Entrée de la session dans le registre
+        RateLimiter limiteur;
+
+        Session(const std::string& pseudo, double debit, double rafale, RateLimiter::Politique politique)
+            : pseudo(pseudo), limiteur(debit, rafale, politique) {}
+    };
+
+    std::string pseudo;              // Pseudonyme du bot
+    int fd_epoll = -1;
+    int fd_inotify = -1;             // Créations dans le dossier des pipes, -1 si indisponible
+    SessionRegistry registry;        // Registre partagé des sessions
+
+    std::unordered_map<std::string, std::unique_ptr<Session>> sessions; // Par pseudonyme
+    std::unordered_map<int, Session*> parDescripteur;    // Sessions par descripteur surveillé
+    std::unordered_map<std::string, double> fermetures;  // Instant de fermeture des dernières sessions
+
+    // Résultats de liste et li, communs à toutes les sessions
+    ResultCache cache;
+
+    // Réponses de liste-bot.txt, chargées une fois pour toutes les sessions,
+    // indexées par leur premier mot et dans l'ordre du fichier
+    std::unordered_map<std::string, std::vector<std::string>> dictionnaire;
+    char tampon[Pipes::IO_BUFFER_SIZE]; // Buffer de lecture commun à toutes les sessions
+
+    void loadDictionary();
+    void scanDirectory();
+    void readInotify();
+    void discover(const std::string& nomPipe);
+    void openSession(Session& s);
+    void closeSession(Session& s, bool supprimerPipes);
+    void retryOpen(Session& s);
+    void watch(Session& s, int fd, uint32_t evenements);
+
+    void handleControl(Session& s);
+    void handleData(Session& s);
+    void handleRequest(Session& s, const std::string& requete);
+    void answerRequest(Session& s, const std::string& requete);
+    void sendReply(Session& s, const std::string& reponse);
+    void flushOutput(Session& s);
+
+    std::string lookup(const std::string& commande) const;
+
+    std::string pipePath(const std::string& de, const std::string& vers, const char* extension) const;
+};
+
+#endif // BOTSERVER_HPP
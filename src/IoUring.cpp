@@ -0,0 +1,598 @@
+// IoUring.cpp
+#include "IoUring.hpp"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <csignal>
+#include <cstring>
+#include <errno.h>
+
+// Nature de l'opération, dans les bits de poids fort de user_data
+static constexpr uint64_t LECTURE = 1ULL << 32;
+static constexpr uint64_t ECRITURE = 2ULL << 32;
+static constexpr uint64_t FOURNITURE = 3ULL << 32;
+static constexpr uint64_t RACCROCHE = 4ULL << 32;
+static constexpr uint64_t ANNULATION = 5ULL << 32;
+static constexpr uint64_t TYPE = 7ULL << 32;
+
+/**
+ * @brief Destructeur de la classe IoUring
+ */
+IoUring::~IoUring() {
+    release();
+}
+
+/**
+ * @brief Crée l'anneau io_uring, vérifie les opérations utilisées et enregistre les buffers
+ * Les appels système sont faits directement, sans liburing. Les messages
+ * envoyés passent par des emplacements enregistrés (WRITE_FIXED) ; chaque
+ * descripteur lu reçoit un groupe de buffers fournis (PROVIDE_BUFFERS) dans
+ * lequel le noyau dépose les données d'une lecture multishot.
+ * @return false si le noyau ne fournit pas io_uring ou les opérations nécessaires
+ */
+bool IoUring::initialize() {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = syscall(__NR_io_uring_setup, NB_ENTREES, &params);
+    if (fd < 0) {
+        return false;
+    }
+    ring_fd = fd;
+    sq_entries = params.sq_entries;
+    sansCompletion = params.features & IORING_FEAT_CQE_SKIP;
+
+    // Attente avec délai (poll) : io_uring_getevents_arg, Linux 5.11
+    if (!(params.features & IORING_FEAT_EXT_ARG) || !probe()) {
+        release();
+        return false;
+    }
+
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    // Projection des deux files (une seule projection si le noyau le permet)
+    bool projectionUnique = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (projectionUnique && cq_ring_size > sq_ring_size) {
+        sq_ring_size = cq_ring_size;
+    }
+    sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+        sq_ring = nullptr;
+        release();
+        return false;
+    }
+    if (projectionUnique) {
+        cq_ring = sq_ring;
+    } else {
+        cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            cq_ring = nullptr;
+            release();
+            return false;
+        }
+    }
+    void* sqes_ptr = mmap(nullptr, params.sq_entries * sizeof(struct io_uring_sqe),
+                          PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring_fd, IORING_OFF_SQES);
+    if (sqes_ptr == MAP_FAILED) {
+        release();
+        return false;
+    }
+    sqes = static_cast<struct io_uring_sqe*>(sqes_ptr);
+
+    char* sq = static_cast<char*>(sq_ring);
+    char* cq = static_cast<char*>(cq_ring);
+    sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Emplacements d'envoi : enregistrés une fois pour toutes (un seul buffer, indice 0)
+    struct iovec envoi = {envoisBuffers, sizeof(envoisBuffers)};
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, &envoi, 1) < 0) {
+        release();
+        return false;
+    }
+    envoisLibres = NB_ENVOIS == 32 ? 0xFFFFFFFFu : (1u << NB_ENVOIS) - 1;
+
+    // Buffers fournis : un groupe par source, donnés au noyau en une opération chacun
+    void* memoire = mmap(nullptr, NB_SOURCES * NB_BUFFERS * TAILLE_BUFFER, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memoire == MAP_FAILED) {
+        release();
+        return false;
+    }
+    buffersFournis = static_cast<char*>(memoire);
+    for (unsigned groupe = 0; groupe < NB_SOURCES; ++groupe) {
+        struct io_uring_sqe* sqe = entree();
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = NB_BUFFERS; // Nombre de buffers
+        sqe->addr = reinterpret_cast<uint64_t>(buffersFournis + groupe * NB_BUFFERS * TAILLE_BUFFER);
+        sqe->len = TAILLE_BUFFER;
+        sqe->off = 0; // Identifiant du premier buffer
+        sqe->buf_group = groupe;
+        sqe->user_data = FOURNITURE | groupe;
+        sources[groupe].libres = NB_BUFFERS;
+        ++fournitures;
+    }
+    while (fournitures > 0) {
+        int ret = enter(true, -1);
+        if (ret < 0 && ret != -EINTR) {
+            release();
+            return false;
+        }
+        reap();
+    }
+    if (erreurFourniture) {
+        release();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Vérifie que le noyau connaît les opérations utilisées
+ * La lecture multishot est facultative : sans elle, chaque lecture est réarmée.
+ * @return false s'il manque une opération indispensable
+ */
+bool IoUring::probe() {
+    const unsigned nbOps = 256;
+    std::vector<char> memoire(sizeof(struct io_uring_probe) + nbOps * sizeof(struct io_uring_probe_op), 0);
+    struct io_uring_probe* sonde = reinterpret_cast<struct io_uring_probe*>(memoire.data());
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, sonde, nbOps) < 0) {
+        return false;
+    }
+
+    auto supportee = [sonde](unsigned op) {
+        return op <= sonde->last_op && (sonde->ops[op].flags & IO_URING_OP_SUPPORTED);
+    };
+    multishotDisponible = supportee(OP_READ_MULTISHOT);
+    return supportee(IORING_OP_READ) && supportee(IORING_OP_WRITE_FIXED) &&
+           supportee(IORING_OP_PROVIDE_BUFFERS);
+}
+
+/**
+ * @brief Libère l'anneau io_uring, ses projections et les buffers fournis
+ * Les écritures en vol sont abandonnées : appeler drain() avant si nécessaire.
+ */
+void IoUring::release() {
+    if (sqes) {
+        munmap(sqes, sq_entries * sizeof(struct io_uring_sqe));
+        sqes = nullptr;
+    }
+    if (cq_ring && cq_ring != sq_ring) {
+        munmap(cq_ring, cq_ring_size);
+    }
+    cq_ring = nullptr;
+    if (sq_ring) {
+        munmap(sq_ring, sq_ring_size);
+        sq_ring = nullptr;
+    }
+    if (ring_fd != -1) {
+        close(ring_fd); // Annule les lectures encore armées
+        ring_fd = -1;
+    }
+    if (buffersFournis) {
+        munmap(buffersFournis, NB_SOURCES * NB_BUFFERS * TAILLE_BUFFER);
+        buffersFournis = nullptr;
+    }
+}
+
+/**
+ * @brief Équivalent de poll() pour des descripteurs lus en continu par le noyau
+ * Au premier appel pour un descripteur, une lecture multishot y est armée ;
+ * ensuite un descripteur est prêt dès que des données reçues attendent d'être
+ * consommées par read(). Les écritures en attente sont soumises dans le même
+ * appel système que l'attente.
+ * @param fds Descripteurs surveillés (fd < 0 ignoré, POLLIN seulement)
+ * @param nfds Nombre de descripteurs
+ * @param timeout Délai en millisecondes, -1 pour attendre indéfiniment
+ * @return Nombre de descripteurs prêts, 0 à l'expiration du délai, -1 avec errno
+ *         (EINTR si l'attente s'est terminée sans donnée, pour revérifier les signaux)
+ */
+int IoUring::poll(struct pollfd* fds, nfds_t nfds, int timeout) {
+    if (nfds > NB_SOURCES) {
+        errno = EINVAL; // Plus de descripteurs que de groupes de buffers
+        return -1;
+    }
+    Source* surveillees[NB_SOURCES] = {};
+    for (nfds_t i = 0; i < nfds; ++i) {
+        fds[i].revents = 0;
+        if (fds[i].fd < 0) continue;
+        surveillees[i] = chercher(fds[i].fd, true);
+        if (!surveillees[i]) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+
+    int prets = 0;
+    bool attendu = false;
+    for (;;) {
+        reap();
+        for (nfds_t i = 0; i < nfds; ++i) {
+            if (!surveillees[i]) continue;
+            armer(*surveillees[i]);
+            if (pret(*surveillees[i])) {
+                fds[i].revents = POLLIN;
+                ++prets;
+            }
+        }
+        if (prets > 0 || attendu) break;
+
+        // Rien de prêt : soumettre et attendre une complétion dans le même appel
+        int ret = enter(timeout != 0, timeout);
+        if (ret == -ETIME) {
+            timeout = 0; // Délai expiré : dernier passage sans attente
+        } else if (ret < 0 && ret != -EINTR) {
+            errno = -ret;
+            return -1;
+        }
+        attendu = true;
+    }
+
+    if (enAttente > 0) {
+        enter(false, 0); // Réarmements et écritures publiés depuis l'attente
+    }
+    if (prets == 0 && timeout != 0) {
+        errno = EINTR; // Réveil par une écriture terminée ou un signal
+        return -1;
+    }
+    return prets;
+}
+
+/**
+ * @brief Équivalent de read() pour un descripteur lu en continu
+ * Consomme les données déjà reçues ; bloque jusqu'à l'arrivée de données sinon.
+ * Un descripteur jamais passé à poll() est lu par read().
+ * @param fd Descripteur à lire
+ * @param buf Buffer de destination
+ * @param count Taille du buffer
+ * @return Nombre d'octets lus, 0 en fin de flux, -1 avec errno en cas d'erreur
+ */
+ssize_t IoUring::read(int fd, void* buf, size_t count) {
+    Source* source = chercher(fd, false);
+    if (!source) {
+        return ::read(fd, buf, count);
+    }
+
+    while (!pret(*source)) {
+        armer(*source);
+        int ret = enter(true, -1);
+        if (ret < 0 && ret != -EINTR && ret != -ETIME) {
+            errno = -ret;
+            return -1;
+        }
+        reap();
+    }
+
+    size_t disponible = source->recus.size() - source->debut;
+    if (disponible == 0) {
+        if (source->erreur) {
+            errno = source->erreur;
+            return -1;
+        }
+        return 0; // Fin de flux
+    }
+    size_t n = disponible < count ? disponible : count;
+    memcpy(buf, source->recus.data() + source->debut, n);
+    source->debut += n;
+    if (source->debut == source->recus.size()) {
+        source->recus.clear();
+        source->debut = 0;
+    }
+
+    // Place libérée : rendre au noyau les buffers retenus
+    if (source->recus.size() - source->debut < ATTENTE_MAX) {
+        for (uint16_t bid : source->retenus) {
+            rendre(*source, bid);
+        }
+        source->retenus.clear();
+    }
+    return n;
+}
+
+/**
+ * @brief Équivalent de write() qui n'attend pas la fin de l'écriture
+ * Le message est copié dans un emplacement enregistré et chaîné à l'écriture
+ * précédente sur le même descripteur : les écritures publiées entre deux
+ * attentes partent ensemble, dans l'ordre, en un seul io_uring_enter. Une
+ * erreur est rapportée à l'écriture suivante (ou par drain()).
+ * @param fd Descripteur d'écriture
+ * @param buf Données à écrire
+ * @param count Nombre d'octets à écrire
+ * @return count, ou -1 avec errno en cas d'erreur
+ */
+ssize_t IoUring::write(int fd, const void* buf, size_t count) {
+    if (count > TAILLE_ENVOI) {
+        // Trop grand pour un emplacement : après les écritures en vol, write() classique
+        if (!drain()) return -1;
+        return ::write(fd, buf, count);
+    }
+
+    // Des écritures déjà soumises attendent encore de la place dans le pipe : les
+    // suivantes ne pouvant plus leur être chaînées, elles attendent leur fin
+    unsigned tous = NB_ENVOIS == 32 ? 0xFFFFFFFFu : (1u << NB_ENVOIS) - 1;
+    reap();
+    while (erreurEnvoi == 0 && (envoisLibres == 0 ||
+           (envoisLibres != tous && (!derniereEcriture || derniereEcritureFd != fd)))) {
+        int ret = enter(true, -1);
+        if (ret < 0 && ret != -EINTR && ret != -ETIME) {
+            errno = -ret;
+            return -1;
+        }
+        reap();
+    }
+    if (erreurEnvoi) {
+        errno = erreurEnvoi;
+        erreurEnvoi = 0;
+        return -1;
+    }
+
+    unsigned emplacement = __builtin_ctz(envoisLibres);
+    envoisLibres &= ~(1u << emplacement);
+    char* donnees = envoisBuffers + emplacement * TAILLE_ENVOI;
+    memcpy(donnees, buf, count);
+
+    if (derniereEcriture && derniereEcritureFd == fd) {
+        derniereEcriture->flags |= IOSQE_IO_LINK; // Dernière entrée publiée, pas encore soumise
+    }
+    struct io_uring_sqe* sqe = entree();
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(donnees);
+    sqe->len = count;
+    sqe->off = static_cast<uint64_t>(-1); // Position courante (pipes)
+    sqe->buf_index = 0;
+    sqe->user_data = ECRITURE | emplacement;
+    derniereEcriture = sqe;
+    derniereEcritureFd = fd;
+    ++envois;
+    return count;
+}
+
+/**
+ * @brief Attend la fin de toutes les écritures soumises ou en attente
+ * @return false si l'une d'elles a échoué (errno positionné)
+ */
+bool IoUring::drain() {
+    unsigned tous = NB_ENVOIS == 32 ? 0xFFFFFFFFu : (1u << NB_ENVOIS) - 1;
+    while (ring_fd != -1 && (envoisLibres != tous || enAttente > 0)) {
+        int ret = enter(envoisLibres != tous, -1);
+        if (ret < 0 && ret != -EINTR && ret != -ETIME) {
+            errno = -ret;
+            return false;
+        }
+        reap();
+    }
+    if (erreurEnvoi) {
+        errno = erreurEnvoi;
+        erreurEnvoi = 0;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Réserve et publie une entrée de soumission, soumise au prochain io_uring_enter
+ */
+struct io_uring_sqe* IoUring::entree() {
+    unsigned tail = *sq_tail;
+    if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= sq_entries) {
+        enter(false, 0); // File pleine : soumettre ce qui est en attente
+    }
+    unsigned index = tail & *sq_mask;
+    struct io_uring_sqe* sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    // Une chaîne d'écritures ne se prolonge que par l'entrée qui la suit directement
+    derniereEcriture = nullptr;
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++enAttente;
+    return sqe;
+}
+
+/**
+ * @brief Soumet les entrées en attente et attend éventuellement une complétion
+ * @param attendre Attendre au moins une complétion
+ * @param timeout Délai d'attente en millisecondes, -1 pour attendre indéfiniment
+ * @return Nombre d'entrées soumises, ou -errno (-ETIME à l'expiration du délai)
+ */
+int IoUring::enter(bool attendre, int timeout) {
+    struct __kernel_timespec delai;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    unsigned flags = 0;
+    if (attendre) {
+        flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+        arg.sigmask_sz = _NSIG / 8;
+        if (timeout >= 0) {
+            delai.tv_sec = timeout / 1000;
+            delai.tv_nsec = (timeout % 1000) * 1000000L;
+            arg.ts = reinterpret_cast<uint64_t>(&delai);
+        }
+    }
+
+    int ret = syscall(__NR_io_uring_enter, ring_fd, enAttente, attendre ? 1 : 0, flags,
+                      attendre ? &arg : nullptr, attendre ? sizeof(arg) : 0);
+    ++appels;
+    if (ret < 0) {
+        return -errno;
+    }
+    enAttente -= static_cast<unsigned>(ret) < enAttente ? ret : enAttente;
+    if (enAttente == 0) {
+        derniereEcriture = nullptr; // Soumise : la suivante commence une nouvelle chaîne
+    }
+    return ret;
+}
+
+/**
+ * @brief Traite les complétions disponibles
+ */
+void IoUring::reap() {
+    unsigned head = __atomic_load_n(cq_head, __ATOMIC_RELAXED);
+    unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        const struct io_uring_cqe& cqe = cqes[head & *cq_mask];
+        uint64_t type = cqe.user_data & TYPE;
+        if (type == LECTURE) {
+            traiterLecture(sources[cqe.user_data & 0xFF], cqe);
+        } else if (type == RACCROCHE) {
+            raccrocher(sources[cqe.user_data & 0xFF], cqe.res);
+        } else if (type == FOURNITURE) {
+            if (fournitures > 0) --fournitures;
+            if (cqe.res < 0) erreurFourniture = -cqe.res;
+        } else if (type == ECRITURE) {
+            envoisLibres |= 1u << (cqe.user_data & 0xFF);
+            // Une écriture annulée suit une écriture en échec de la même chaîne
+            if (cqe.res < 0 && cqe.res != -ECANCELED && erreurEnvoi == 0) {
+                erreurEnvoi = -cqe.res;
+            }
+        }
+    }
+    __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Range les données d'une complétion de lecture
+ * @param source Descripteur lu
+ * @param cqe Complétion
+ */
+void IoUring::traiterLecture(Source& source, const struct io_uring_cqe& cqe) {
+    ++lectures;
+    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        source.armee = false; // Lecture terminée, réarmée au besoin
+    }
+    if (cqe.flags & IORING_CQE_F_BUFFER) {
+        uint16_t bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+        --source.libres;
+        if (cqe.res > 0) {
+            const char* donnees = buffersFournis + (&source - sources) * NB_BUFFERS * TAILLE_BUFFER + bid * TAILLE_BUFFER;
+            source.recus.insert(source.recus.end(), donnees, donnees + cqe.res);
+        }
+        // Au-delà de ATTENTE_MAX, le buffer n'est rendu qu'une fois les données
+        // consommées : le noyau cesse de lire et l'expéditeur est freiné par le pipe plein
+        if (source.recus.size() - source.debut < ATTENTE_MAX) {
+            rendre(source, bid);
+        } else {
+            source.retenus.push_back(bid);
+        }
+    }
+
+    if (cqe.res == 0) {
+        source.fin = true;
+    } else if (cqe.res == -EBADFD || (cqe.res == -EINVAL && source.multishot)) {
+        source.multishot = false; // Descripteur non pollable (fichier ordinaire) : lectures simples
+    } else if (cqe.res < 0 && cqe.res != -ENOBUFS && cqe.res != -EINTR && cqe.res != -EAGAIN &&
+               cqe.res != -ECANCELED) {
+        source.erreur = -cqe.res;
+    }
+}
+
+/**
+ * @brief Arme une lecture sur un descripteur si aucune n'est en cours
+ * Sans buffer disponible, la lecture attend que des données soient consommées.
+ * @param source Descripteur à lire
+ */
+void IoUring::armer(Source& source) {
+    unsigned groupe = &source - sources;
+    if (source.multishot && !source.surveillee) {
+        // Une lecture multishot en attente n'est pas réveillée par la fermeture de
+        // l'autre extrémité si le pipe était déjà vide : POLLHUP est surveillé à part
+        struct io_uring_sqe* sqe = entree();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = source.fd;
+        sqe->poll32_events = POLLHUP;
+        sqe->user_data = RACCROCHE | groupe;
+        source.surveillee = true;
+    }
+    if (source.armee || source.fin || source.erreur || source.libres == 0) return;
+
+    struct io_uring_sqe* sqe = entree();
+    sqe->opcode = source.multishot ? OP_READ_MULTISHOT : static_cast<uint8_t>(IORING_OP_READ);
+    sqe->fd = source.fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = groupe;
+    sqe->len = source.multishot ? 0 : TAILLE_BUFFER; // Multishot : taille des buffers fournis
+    sqe->off = static_cast<uint64_t>(-1); // Position courante
+    sqe->user_data = LECTURE | groupe;
+    source.armee = true;
+}
+
+/**
+ * @brief Traite la fermeture de l'autre extrémité d'un descripteur lu en multishot
+ * La lecture multishot est annulée ; les lectures simples qui la remplacent
+ * rendent les données restantes puis la fin de flux.
+ * @param source Descripteur lu
+ * @param masque Résultat de POLL_ADD (événements, ou -errno)
+ */
+void IoUring::raccrocher(Source& source, int masque) {
+    if (masque <= 0 || !(masque & POLLHUP)) return; // Non pollable ou surveillance annulée
+
+    source.multishot = false;
+    if (source.armee) {
+        struct io_uring_sqe* sqe = entree();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = LECTURE | (&source - sources); // Complétion -ECANCELED sans IORING_CQE_F_MORE
+        sqe->user_data = ANNULATION;
+        if (sansCompletion) {
+            sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+        }
+    }
+}
+
+/**
+ * @brief Rend un buffer fourni au noyau
+ * L'opération part avec la prochaine soumission, avant un éventuel réarmement.
+ * @param source Descripteur propriétaire du groupe de buffers
+ * @param bid Identifiant du buffer
+ */
+void IoUring::rendre(Source& source, uint16_t bid) {
+    unsigned groupe = &source - sources;
+    struct io_uring_sqe* sqe = entree();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = 1;
+    sqe->addr = reinterpret_cast<uint64_t>(buffersFournis + (groupe * NB_BUFFERS + bid) * TAILLE_BUFFER);
+    sqe->len = TAILLE_BUFFER;
+    sqe->off = bid;
+    sqe->buf_group = groupe;
+    sqe->user_data = FOURNITURE | groupe;
+    if (sansCompletion) {
+        sqe->flags = IOSQE_CQE_SKIP_SUCCESS; // Seul un échec produit une complétion
+    }
+    ++source.libres;
+}
+
+/**
+ * @brief Cherche la source d'un descripteur
+ * @param fd Descripteur
+ * @param creer Associer une source libre au descripteur s'il n'en a pas
+ * @return La source, nullptr si le descripteur n'est pas lu en continu
+ */
+IoUring::Source* IoUring::chercher(int fd, bool creer) {
+    Source* libre = nullptr;
+    for (Source& source : sources) {
+        if (source.fd == fd) return &source;
+        if (!libre && source.fd == -1) libre = &source;
+    }
+    if (!creer || !libre) return nullptr;
+
+    libre->fd = fd;
+    libre->multishot = multishotDisponible;
+    return libre;
+}
+
+/**
+ * @brief Indique si read() rendrait la main sans attendre
+ */
+bool IoUring::pret(const Source& source) const {
+    return source.debut < source.recus.size() || source.fin || source.erreur;
+}
@@ -0,0 +1,103 @@
+// IoUring.hpp
+#ifndef IOURING_HPP
+#define IOURING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <poll.h>
+#include <sys/types.h>
+#include <linux/io_uring.h>
+
+class IoUring {
+public:
+    // Constantes
+    static constexpr unsigned NB_ENTREES = 64;        // Taille de la file de soumission
+    static constexpr unsigned NB_SOURCES = 4;         // Descripteurs lus en continu au plus
+    static constexpr unsigned NB_BUFFERS = 8;         // Buffers fournis au noyau par descripteur
+    static constexpr size_t TAILLE_BUFFER = 4096;     // Taille d'un buffer fourni
+    static constexpr unsigned NB_ENVOIS = 32;         // Écritures en vol au plus
+    static constexpr size_t TAILLE_ENVOI = 256;       // Taille d'un emplacement d'envoi enregistré
+    static constexpr size_t ATTENTE_MAX = 64 * 1024;  // Données reçues non consommées avant de freiner le noyau
+    static constexpr uint8_t OP_READ_MULTISHOT = 49;  // IORING_OP_READ_MULTISHOT (Linux 6.7), absent des en-têtes anciens
+
+    // Compteurs
+    unsigned long appels = 0;        // Appels à io_uring_enter
+    unsigned long lectures = 0;      // Complétions de lecture
+    unsigned long envois = 0;        // Écritures soumises
+
+    // Constructeur et destructeur
+    IoUring() = default;
+    ~IoUring();
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // Fonctions
+    bool initialize();
+    void release();
+    int poll(struct pollfd* fds, nfds_t nfds, int timeout);
+    ssize_t read(int fd, void* buf, size_t count);
+    ssize_t write(int fd, const void* buf, size_t count);
+    bool drain();
+
+private:
+    // Descripteur lu en continu par le noyau, dans un groupe de buffers fournis
+    struct Source {
+        int fd = -1;
+        bool armee = false;              // Lecture en cours dans le noyau
+        bool multishot = true;           // Descripteur pollable : une lecture armée sert plusieurs fois
+        bool surveillee = false;         // Fermeture de l'autre extrémité surveillée (POLL_ADD)
+        bool fin = false;                // Fin de flux
+        int erreur = 0;                  // errno de la dernière lecture en échec
+        std::vector<char> recus;         // Données reçues non consommées
+        size_t debut = 0;                // Début des données non consommées
+        std::vector<uint16_t> retenus;   // Buffers rendus au noyau une fois les données consommées
+        unsigned libres = 0;             // Buffers à disposition du noyau
+    };
+
+    int ring_fd = -1;                // Descripteur de l'anneau io_uring
+
+    void* sq_ring = nullptr;         // Projection de la file de soumission
+    void* cq_ring = nullptr;         // Projection de la file de complétion
+    size_t sq_ring_size = 0;
+    size_t cq_ring_size = 0;
+    unsigned sq_entries = 0;
+    struct io_uring_sqe* sqes = nullptr; // Tableau des entrées de soumission
+
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    struct io_uring_cqe* cqes = nullptr;
+
+    bool multishotDisponible = false; // Lecture multishot reconnue par le noyau
+    bool sansCompletion = false;     // IOSQE_CQE_SKIP_SUCCESS reconnu par le noyau
+    Source sources[NB_SOURCES];
+    char* buffersFournis = nullptr;  // Buffers fournis au noyau, NB_BUFFERS par source
+    unsigned fournitures = 0;        // Fournitures de buffers dont la complétion est attendue
+    int erreurFourniture = 0;        // errno d'une fourniture de buffers en échec
+
+    char envoisBuffers[NB_ENVOIS * TAILLE_ENVOI]; // Emplacements d'envoi enregistrés
+    uint32_t envoisLibres = 0;       // Emplacements d'envoi disponibles (un bit chacun)
+    int erreurEnvoi = 0;             // errno d'une écriture en échec, rapporté à l'écriture suivante
+
+    unsigned enAttente = 0;          // Entrées publiées mais pas encore soumises
+    struct io_uring_sqe* derniereEcriture = nullptr; // Dernière écriture non soumise, pour chaîner la suivante
+    int derniereEcritureFd = -1;
+
+    bool probe();
+    struct io_uring_sqe* entree();
+    int enter(bool attendre, int timeout);
+    void reap();
+    void traiterLecture(Source& source, const struct io_uring_cqe& cqe);
+    void armer(Source& source);
+    void raccrocher(Source& source, int masque);
+    void rendre(Source& source, uint16_t bid);
+    Source* chercher(int fd, bool creer);
+    bool pret(const Source& source) const;
+};
+
+#endif // IOURING_HPP
@@ -1,10 +1,12 @@
 // ParameterValidator.cpp
 #include "ParameterValidator.hpp"
+#include "RateLimiter.hpp"
 #include <string>
 #include <vector>
 #include <algorithm>
 #include <cstdio>
 #include <cstdlib>
+#include <cmath>
 
 // Déclaration des variables globales utilisées
 extern std::string pseudo_utilisateur;
@@ -12,6 +14,14 @@ extern std::string pseudo_destinataire;
 extern bool isBotMode;
 extern bool isManuelMode;
 extern bool isJoliMode;
+extern bool isLimiteMode;
+extern bool isUringMode;
+extern bool isServeurMode;
+extern bool isWhoMode;
+extern double botDebit;
+extern double botRafale;
+extern RateLimiter::Politique botPolitique;
+extern size_t botCache;
 
 // Fonction utilisée
 extern bool containsChar(const std::string& str, char ch);
@@ -22,6 +32,28 @@ extern bool containsChar(const std::string& str, char ch);
  * @param argv Tableau des arguments
  */
 void ParameterValidator::checkParams(int argc, char* argv[]) {
+    // Liste des sessions en cours : chat --who [pseudo], pseudo filtré dans pseudo_utilisateur
+    if (argc >= 2 && std::string(argv[1]) == "--who") {
+        isWhoMode = true;
+        pseudo_utilisateur = argc >= 3 ? argv[2] : "";
+        return;
+    }
+
+    // Serveur de bot : chat --serveur [pseudo_bot] [options], pseudo du bot dans pseudo_utilisateur
+    if (argc >= 2 && std::string(argv[1]) == "--serveur") {
+        bool pseudoDonne = argc >= 3 && std::string(argv[2]).rfind("--", 0) != 0;
+        isServeurMode = true;
+        pseudo_utilisateur = pseudoDonne ? argv[2] : "bot";
+        checkPseudos(pseudo_utilisateur, pseudo_utilisateur);
+        checkOptions(argc, argv, pseudoDonne ? 3 : 2);
+        // Options propres à une discussion, sans effet sur le serveur
+        if (isBotMode || isManuelMode || isJoliMode) {
+            fprintf(stderr, "Erreur : --bot, --manuel et --joli ne s'utilisent pas avec --serveur.\n");
+            exit(1);
+        }
+        return;
+    }
+
     if (argc < 3) {
         fprintf(stderr, "chat pseudo_utilisateur pseudo_destinataire [--bot] [--manuel]\n");
         exit(1);
@@ -30,15 +62,25 @@ void ParameterValidator::checkParams(int argc, char* argv[]) {
     pseudo_utilisateur = argv[1];
     pseudo_destinataire = argv[2];
 
+    checkPseudos(pseudo_utilisateur, pseudo_destinataire);
+    checkOptions(argc, argv, 3);
+}
+
+/**
+ * @brief Vérifie les pseudonymes, termine le programme s'ils sont invalides
+ * @param utilisateur Pseudonyme de l'utilisateur
+ * @param destinataire Pseudonyme du destinataire
+ */
+void ParameterValidator::checkPseudos(const std::string& utilisateur, const std::string& destinataire) {
     // Vérification de la longueur des pseudonymes
-    if (pseudo_utilisateur.size() > 30 || pseudo_destinataire.size() > 30) {
+    if (utilisateur.size() > 30 || destinataire.size() > 30) {
         fprintf(stderr, "Erreur : Les pseudonymes ne doivent pas dépasser 30 caractères.\n");
         exit(2);
     }
 
     // Vérification des pseudonymes interdits
-    if (pseudo_utilisateur == "." || pseudo_utilisateur == ".." ||
-        pseudo_destinataire == "." || pseudo_destinataire == "..") {
+    if (utilisateur == "." || utilisateur == ".." ||
+        destinataire == "." || destinataire == "..") {
         fprintf(stderr, "Erreur : Les pseudonymes ne peuvent pas être '.' ou '..'.\n");
         exit(3);
     }
@@ -46,16 +88,60 @@ void ParameterValidator::checkParams(int argc, char* argv[]) {
     // Vérification des caractères interdits dans les pseudonymes
     std::vector<char> caracteres_interdits = {'/', '[', ']', '-'};
     for (char caractere : caracteres_interdits) {
-        if (containsChar(pseudo_utilisateur, caractere) || containsChar(pseudo_destinataire, caractere)) {
+        if (containsChar(utilisateur, caractere) || containsChar(destinataire, caractere)) {
             fprintf(stderr, "Erreur : Les pseudonymes contiennent des caractères interdits (/, -, [, ]).\n");
             exit(3);
         }
     }
+}
 
-    // Traitement des options
-    for (int i = 3; i < argc; ++i) {
+/**
+ * @brief Traite les options qui suivent les pseudonymes
+ * @param argc Nombre d'arguments
+ * @param argv Tableau des arguments
+ * @param debut Indice de la première option
+ */
+void ParameterValidator::checkOptions(int argc, char* argv[], int debut) {
+    for (int i = debut; i < argc; ++i) {
         if (std::string(argv[i]) == "--bot") isBotMode = true;
         if (std::string(argv[i]) == "--manuel") isManuelMode = true;
         if (std::string(argv[i]) == "--joli") isJoliMode = true;
+        if (std::string(argv[i]) == "--uring") isUringMode = true;
+
+        // Limitation des requêtes en mode bot : --debit=N --rafale=N --delestage=politique
+        std::string option(argv[i]);
+        bool estDebit = option.rfind("--debit=", 0) == 0;
+        if (estDebit || option.rfind("--rafale=", 0) == 0) {
+            std::string valeur = option.substr(option.find('=') + 1);
+            char* fin = nullptr;
+            double nombre = strtod(valeur.c_str(), &fin);
+            // Une rafale inférieure à 1 ne laisserait jamais passer de requête
+            if (valeur.empty() || *fin != '\0' || !std::isfinite(nombre) || nombre <= 0 ||
+                (!estDebit && nombre < 1)) {
+                fprintf(stderr, "Erreur : valeur invalide pour %s.\n", option.c_str());
+                exit(1);
+            }
+            if (estDebit) botDebit = nombre;
+            else botRafale = nombre;
+            isLimiteMode = true;
+        }
+        // Budget du cache de résultats du serveur de bot, en Kio (0 pour le désactiver)
+        if (option.rfind("--cache=", 0) == 0) {
+            std::string valeur = option.substr(8);
+            char* fin = nullptr;
+            unsigned long kio = strtoul(valeur.c_str(), &fin, 10);
+            if (valeur.empty() || valeur[0] == '-' || *fin != '\0') {
+                fprintf(stderr, "Erreur : valeur invalide pour %s.\n", option.c_str());
+                exit(1);
+            }
+            botCache = kio * 1024;
+        }
+        if (option.rfind("--delestage=", 0) == 0) {
+            if (!RateLimiter::parsePolitique(option.substr(12), botPolitique)) {
+                fprintf(stderr, "Erreur : politique de délestage inconnue (occupe, ignorer, fusionner).\n");
+                exit(1);
+            }
+            isLimiteMode = true;
+        }
     }
 }
@@ -2,10 +2,16 @@
 #ifndef PARAMETERVALIDATOR_HPP
 #define PARAMETERVALIDATOR_HPP
 
+#include <string>
+
 class ParameterValidator {
 public:
     // Fonctions
     void checkParams(int argc, char* argv[]);
+
+private:
+    void checkPseudos(const std::string& utilisateur, const std::string& destinataire);
+    void checkOptions(int argc, char* argv[], int debut);
 };
 
 #endif // PARAMETERVALIDATOR_HPP
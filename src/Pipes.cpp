@@ -1,19 +1,26 @@
 #include "Pipes.hpp"
+#include "IoUring.hpp"
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <errno.h>
+#include <csignal>
+#include <ctime>
 
 /**
  * @brief Constructeur de la classe Pipes
  * @param pseudo_utilisateur Pseudonyme de l'utilisateur
  * @param pseudo_destinataire Pseudonyme du destinataire
  */
-Pipes::Pipes(const std::string& pseudo_utilisateur, const std::string& pseudo_destinataire) {
+Pipes::Pipes(const std::string& pseudo_utilisateur, const std::string& pseudo_destinataire)
+    : utilisateur(pseudo_utilisateur), destinataire(pseudo_destinataire) {
     sendPipe = "/tmp/" + pseudo_utilisateur + "-" + pseudo_destinataire + ".chat";
     receivePipe = "/tmp/" + pseudo_destinataire + "-" + pseudo_utilisateur + ".chat";
+    sendCtrlPipe = "/tmp/" + pseudo_utilisateur + "-" + pseudo_destinataire + ".ctrl";
+    receiveCtrlPipe = "/tmp/" + pseudo_destinataire + "-" + pseudo_utilisateur + ".ctrl";
 }
 
 /**
@@ -31,9 +38,11 @@ void Pipes::createPipe(const std::string& pipePath) {
 }
 
 /**
- * @brief Supprime les pipes nommés
+ * @brief Supprime les pipes nommés et retire la session du registre
  */
 void Pipes::unlink_pipes() {
+    registry.remove(sessionSlot, sessionPid); // Sans effet si la session n'est pas enregistrée
+    sessionSlot = -1;
     if (unlink(sendPipe.c_str()) == -1) {
         if (errno != ENOENT) {
             perror("Erreur lors de la suppression du pipe d'envoi");
@@ -44,4 +53,254 @@ void Pipes::unlink_pipes() {
             perror("Erreur lors de la suppression du pipe de réception");
         }
     }
+    if (unlink(sendCtrlPipe.c_str()) == -1) {
+        if (errno != ENOENT) {
+            perror("Erreur lors de la suppression du pipe de contrôle d'envoi");
+        }
+    }
+    if (unlink(receiveCtrlPipe.c_str()) == -1) {
+        if (errno != ENOENT) {
+            perror("Erreur lors de la suppression du pipe de contrôle de réception");
+        }
+    }
+}
+
+/**
+ * @brief Inscrit la session dans le registre partagé
+ * Sans registre disponible, la session fonctionne normalement mais n'apparaît pas dans chat --who.
+ * @param mode Options de la session (SessionRegistry::Mode)
+ */
+void Pipes::register_session(uint32_t mode) {
+    if (registry.open()) {
+        sessionPid = getpid();
+        sessionSlot = registry.add(utilisateur, destinataire, sessionPid, mode);
+    }
+}
+
+/**
+ * @brief Met à jour le signe de vie de la session (utilisable depuis un gestionnaire de signal)
+ */
+void Pipes::heartbeat() {
+    registry.heartbeat(sessionSlot, sessionPid);
+}
+
+/**
+ * @brief Indique si le destinataire a une session vivante ouverte vers l'utilisateur
+ */
+bool Pipes::peerConnected() {
+    SessionRegistry::Session session;
+    return registry.find(destinataire, utilisateur, session) && session.vivante;
+}
+
+/**
+ * @brief Choisit le backend d'entrées/sorties du processus courant
+ * À appeler après le fork : un anneau io_uring ne se partage pas entre processus.
+ * @param useUring Tenter d'utiliser io_uring
+ * @return true si io_uring est actif, false si read/write/poll classiques sont utilisés
+ */
+bool Pipes::initialize_io(bool useUring) {
+    if (!useUring) return false;
+
+    uring = new IoUring();
+    if (!uring->initialize()) {
+        // Noyau sans io_uring, opération manquante ou appel interdit : repli sur read/write
+        delete uring;
+        uring = nullptr;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Termine les écritures en cours et libère le backend d'entrées/sorties
+ * À appeler avant de fermer les pipes d'envoi.
+ */
+void Pipes::release_io() {
+    if (uring) {
+        if (!uring->drain()) {
+            perror("Erreur lors de l'écriture dans le pipe");
+        }
+        delete uring;
+        uring = nullptr;
+    }
+}
+
+/**
+ * @brief Attend que des données soient lisibles, comme poll()
+ * Avec io_uring, l'attente soumet aussi les écritures en attente.
+ * @param fds Descripteurs surveillés (POLLIN)
+ * @param nfds Nombre de descripteurs
+ * @param timeout Délai en millisecondes, -1 pour attendre indéfiniment
+ * @return Nombre de descripteurs prêts, 0 à l'expiration du délai, -1 en cas d'erreur
+ */
+int Pipes::wait(struct pollfd* fds, nfds_t nfds, int timeout) {
+    return uring ? uring->poll(fds, nfds, timeout) : poll(fds, nfds, timeout);
+}
+
+/**
+ * @brief Lit des données brutes sur un descripteur surveillé par wait()
+ * @return Nombre d'octets lus, 0 en fin de flux, -1 en cas d'erreur
+ */
+ssize_t Pipes::readData(int fd, void* buf, size_t count) {
+    return uring ? uring->read(fd, buf, count) : read(fd, buf, count);
+}
+
+/**
+ * @brief Lit un message terminé par '\0' depuis un pipe
+ * Le pipe est lu par blocs de IO_BUFFER_SIZE octets ; les octets en trop sont
+ * conservés pour les messages suivants (cf. hasBufferedData).
+ * @param fd Descripteur du pipe de réception
+ * @param buffer Buffer de destination
+ * @param max_size Taille du buffer de destination
+ * @return Taille lue ('\0' compris si le message est complet), 0 en fin de flux, -1 en cas d'erreur
+ */
+ssize_t Pipes::receiveMessage(int fd, char* buffer, size_t max_size) {
+    size_t total_read = 0;
+    while (total_read < max_size - 1) { // On laisse de la place pour le '\0'
+        if (recvStart == recvEnd) {
+            // Buffer vide : recharger depuis le pipe
+            ssize_t bytes_read = readData(fd, recvBuffer, IO_BUFFER_SIZE);
+            if (bytes_read == -1) {
+                if (errno == EINTR) {
+                    continue; // Interruption par un signal, on réessaie
+                }
+                perror("Erreur lors de la lecture du pipe de réception");
+                return -1;
+            } else if (bytes_read == 0) {
+                // Fin du flux
+                if (total_read == 0) {
+                    return 0;
+                }
+                buffer[total_read] = '\0'; // Données partielles lues
+                return total_read;
+            }
+            recvStart = 0;
+            recvEnd = bytes_read;
+        }
+
+        // Copie jusqu'au prochain '\0' présent dans le buffer
+        size_t disponible = recvEnd - recvStart;
+        size_t place = max_size - 1 - total_read;
+        size_t n = disponible < place ? disponible : place;
+        const char* debut = recvBuffer + recvStart;
+        const char* fin = static_cast<const char*>(memchr(debut, '\0', n));
+        if (fin) {
+            size_t longueur = fin - debut + 1;
+            memcpy(buffer + total_read, debut, longueur);
+            recvStart += longueur;
+            return total_read + longueur; // Fin du message
+        }
+        memcpy(buffer + total_read, debut, n);
+        recvStart += n;
+        total_read += n;
+    }
+    // Si on arrive ici, le buffer est plein
+    buffer[total_read] = '\0';
+    return total_read;
+}
+
+/**
+ * @brief Écrit l'intégralité d'un buffer dans un pipe
+ * @param fd Descripteur du pipe d'envoi
+ * @param buf Données à écrire
+ * @param count Nombre d'octets à écrire
+ * @return Nombre d'octets écrits, -1 en cas d'erreur
+ */
+ssize_t Pipes::sendMessage(int fd, const char* buf, size_t count) {
+    size_t total_written = 0;
+
+    while (total_written < count) {
+        // Avec io_uring, l'écriture part avec la prochaine attente (wait)
+        ssize_t bytes_written = uring ? uring->write(fd, buf + total_written, count - total_written)
+                                      : write(fd, buf + total_written, count - total_written);
+        if (bytes_written == -1) {
+            if (errno == EINTR) {
+                continue; // Interruption par un signal, on réessaie
+            }
+            // Erreur critique
+            perror("Erreur lors de l'écriture dans le pipe");
+            return -1;
+        }
+        total_written += bytes_written;
+    }
+    return total_written;
+}
+
+/**
+ * @brief Envoie une trame de contrôle sur le pipe de contrôle
+ * Utilisable depuis un gestionnaire de signal : un SIGPIPE provoqué par un
+ * destinataire déjà parti est absorbé au lieu de terminer le programme.
+ * @param fd Descripteur du pipe de contrôle d'envoi
+ * @param type Type de la trame
+ * @param argument Argument optionnel de la trame
+ * @return true si la trame a été écrite
+ */
+bool Pipes::sendControl(int fd, TypeControle type, uint32_t argument) {
+    if (fd == -1) return false;
+
+    TrameControle trame = {type, {0, 0, 0}, argument};
+
+    // Bloquer SIGPIPE le temps de l'écriture
+    sigset_t masque, ancien;
+    sigemptyset(&masque);
+    sigaddset(&masque, SIGPIPE);
+    sigprocmask(SIG_BLOCK, &masque, &ancien);
+
+    ssize_t ecrit;
+    do {
+        ecrit = write(fd, &trame, sizeof(trame)); // Atomique car < PIPE_BUF
+    } while (ecrit == -1 && errno == EINTR);
+
+    if (ecrit == -1 && errno == EPIPE) {
+        // Consommer le SIGPIPE en attente avant de restaurer le masque
+        struct timespec zero = {0, 0};
+        sigtimedwait(&masque, nullptr, &zero);
+    }
+    sigprocmask(SIG_SETMASK, &ancien, nullptr);
+
+    return ecrit == static_cast<ssize_t>(sizeof(trame));
+}
+
+/**
+ * @brief Lit une trame de contrôle complète
+ * @param fd Descripteur du pipe de contrôle de réception
+ * @param trame Trame lue
+ * @return Taille de la trame, 0 en fin de flux, -1 en cas d'erreur
+ */
+ssize_t Pipes::readControl(int fd, TrameControle& trame) {
+    size_t total_read = 0;
+    char* buffer = reinterpret_cast<char*>(&trame);
+    while (total_read < sizeof(trame)) {
+        ssize_t bytes_read = read(fd, buffer + total_read, sizeof(trame) - total_read);
+        if (bytes_read == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (bytes_read == 0) return 0; // Trame tronquée traitée comme une fin de flux
+        total_read += bytes_read;
+    }
+    return total_read;
+}
+
+/**
+ * @brief Lit une trame de contrôle complète sur un descripteur surveillé par wait()
+ * @param fd Descripteur du pipe de contrôle
+ * @param trame Trame lue
+ * @return Taille de la trame, 0 en fin de flux, -1 en cas d'erreur
+ */
+ssize_t Pipes::receiveControl(int fd, TrameControle& trame) {
+    if (!uring) return readControl(fd, trame);
+
+    size_t total_read = 0;
+    char* buffer = reinterpret_cast<char*>(&trame);
+    while (total_read < sizeof(trame)) {
+        ssize_t bytes_read = uring->read(fd, buffer + total_read, sizeof(trame) - total_read);
+        if (bytes_read == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (bytes_read == 0) return 0; // Trame tronquée traitée comme une fin de flux
+        total_read += bytes_read;
+    }
+    return total_read;
 }
@@ -2,9 +2,33 @@
 #define PIPES_HPP
 
 #include <string>
+#include <cstdint>
+#include <sys/types.h>
+#include <poll.h>
+#include "SessionRegistry.hpp"
+
+// Types de trames de contrôle échangées hors bande, entre les deux utilisateurs
+// ou du processus de réception vers le processus d'envoi d'un même chat
+enum class TypeControle : uint8_t {
+    DISCONNECT = 1,                  // L'expéditeur quitte la session (ou l'autre utilisateur l'a quittée)
+    FLUSH      = 2,                  // Mémoire partagée pleine : afficher les messages en attente
+    HEARTBEAT  = 5,                  // Signe de vie de l'expéditeur
+};
+
+// Trame de contrôle de taille fixe (écriture atomique, < PIPE_BUF)
+struct TrameControle {
+    TypeControle type;
+    uint8_t reserve[3];
+    uint32_t argument;
+};
+
+class IoUring;
 
 class Pipes {
 public:
+    // Constante
+    static constexpr size_t IO_BUFFER_SIZE = 4096; // Taille des buffers d'entrées/sorties
+
     // Variables membres
     bool pipesOuverts = false;       // Indique si les pipes ont été ouverts
 
@@ -12,6 +36,19 @@ public:
     int fd_send = -1;                // Descripteur du pipe d'envoi
     std::string sendPipe;            // Nom du pipe d'envoi
     std::string receivePipe;         // Nom du pipe de réception
+    std::string sendCtrlPipe;        // Nom du pipe de contrôle d'envoi
+    std::string receiveCtrlPipe;     // Nom du pipe de contrôle de réception
+    std::string utilisateur;         // Pseudonyme de l'utilisateur
+    std::string destinataire;        // Pseudonyme du destinataire
+
+    SessionRegistry registry;        // Registre partagé des sessions
+    long sessionSlot = -1;           // Entrée de la session dans le registre
+    pid_t sessionPid = -1;           // Processus propriétaire de l'entrée
+
+    char recvBuffer[IO_BUFFER_SIZE]; // Données reçues pas encore découpées en messages
+    size_t recvStart = 0;            // Début des données non consommées
+    size_t recvEnd = 0;              // Fin des données reçues
+    IoUring* uring = nullptr;        // Backend io_uring, nullptr pour read/write/poll classiques
 
     // Constructeur
     Pipes(const std::string& pseudo_utilisateur, const std::string& pseudo_destinataire);
@@ -19,6 +56,27 @@ public:
     // Fonctions
     void createPipe(const std::string& pipePath);
     void unlink_pipes(); // Ajout de cette méthode
+
+    // Registre des sessions
+    void register_session(uint32_t mode);
+    void heartbeat();
+    bool peerConnected();
+
+    // Backend d'entrées/sorties
+    bool initialize_io(bool useUring);
+    void release_io();
+    int wait(struct pollfd* fds, nfds_t nfds, int timeout);
+    ssize_t readData(int fd, void* buf, size_t count);
+
+    // Messages
+    bool hasBufferedData() const { return recvStart < recvEnd; }
+    ssize_t receiveMessage(int fd, char* buffer, size_t max_size);
+    ssize_t sendMessage(int fd, const char* buf, size_t count);
+
+    // Canal de contrôle
+    static bool sendControl(int fd, TypeControle type, uint32_t argument = 0);
+    static ssize_t readControl(int fd, TrameControle& trame);
+    ssize_t receiveControl(int fd, TrameControle& trame);
 };
 
 #endif // PIPES_HPP
@@ -0,0 +1,116 @@
+// RateLimiter.cpp
+#include "RateLimiter.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Fonction utilisée
+extern double maintenant();
+
+/**
+ * @brief Constructeur de la classe RateLimiter (seau de jetons)
+ * @param debit Nombre de requêtes acceptées par seconde en régime établi
+ * @param rafale Nombre de requêtes acceptées d'un coup après une période calme
+ * @param politique Politique de délestage quand la file est pleine
+ */
+RateLimiter::RateLimiter(double debit, double rafale, Politique politique)
+    : debit(debit), rafale(rafale), jetons(rafale),
+      dernierRemplissage(maintenant()), politique(politique) {
+}
+
+/**
+ * @brief Ajoute les jetons gagnés depuis le dernier remplissage
+ */
+void RateLimiter::remplir() {
+    double t = maintenant();
+    jetons = std::min(rafale, jetons + (t - dernierRemplissage) * debit);
+    dernierRemplissage = t;
+}
+
+/**
+ * @brief Soumet une requête reçue
+ * @param requete Texte de la requête
+ * @return Décision : à traiter, en file ou délestée
+ */
+RateLimiter::Decision RateLimiter::submit(const std::string& requete) {
+    remplir();
+
+    // Les requêtes en file passent avant, pour conserver l'ordre
+    if (file.empty() && jetons >= 1.0) {
+        jetons -= 1.0;
+        acceptees++;
+        return Decision::ACCEPTEE;
+    }
+
+    if (politique == Politique::FUSIONNER &&
+        std::find(file.begin(), file.end(), requete) != file.end()) {
+        // La réponse à la requête déjà en file vaudra pour celle-ci
+        fusionnees++;
+        return Decision::FUSIONNEE;
+    }
+
+    if (file.size() < TAILLE_FILE) {
+        file.push_back(requete);
+        return Decision::EN_FILE;
+    }
+
+    if (politique == Politique::OCCUPE) {
+        occupees++;
+        return Decision::OCCUPEE;
+    }
+    ignorees++;
+    return Decision::IGNOREE;
+}
+
+/**
+ * @brief Retire la prochaine requête en file si un jeton est disponible
+ * @param requete Requête retirée
+ * @return true si une requête est à traiter
+ */
+bool RateLimiter::nextReady(std::string& requete) {
+    if (file.empty()) return false;
+    remplir();
+    if (jetons < 1.0) return false;
+
+    jetons -= 1.0;
+    acceptees++;
+    requete = std::move(file.front());
+    file.pop_front();
+    return true;
+}
+
+/**
+ * @brief Délai d'attente à passer à poll()
+ * @return Millisecondes avant le prochain jeton si des requêtes sont en file, -1 sinon
+ */
+int RateLimiter::pollTimeout() {
+    if (file.empty()) return -1;
+    remplir();
+    if (jetons >= 1.0) return 0;
+    double attente = std::ceil((1.0 - jetons) / debit * 1000.0);
+    // Borné avant la conversion (débit très faible) ; le délai est recalculé au réveil
+    if (!(attente < ATTENTE_MAX_MS)) return ATTENTE_MAX_MS;
+    return attente > 0 ? static_cast<int>(attente) : 0;
+}
+
+/**
+ * @brief Affiche les compteurs de délestage
+ * @param flux Flux de sortie
+ */
+void RateLimiter::print_stats(FILE* flux) const {
+    fprintf(flux, "Requêtes traitées : %lu, délestées : %lu (occupé : %lu, ignorées : %lu, fusionnées : %lu)\n",
+            acceptees, occupees + ignorees + fusionnees, occupees, ignorees, fusionnees);
+}
+
+/**
+ * @brief Convertit le nom d'une politique de délestage
+ * @param nom "occupe", "ignorer" ou "fusionner"
+ * @param politique Politique correspondante
+ * @return false si le nom est inconnu
+ */
+bool RateLimiter::parsePolitique(const std::string& nom, Politique& politique) {
+    if (nom == "occupe") politique = Politique::OCCUPE;
+    else if (nom == "ignorer") politique = Politique::IGNORER;
+    else if (nom == "fusionner") politique = Politique::FUSIONNER;
+    else return false;
+    return true;
+}
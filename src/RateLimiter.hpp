@@ -0,0 +1,62 @@
+// RateLimiter.hpp
+#ifndef RATELIMITER_HPP
+#define RATELIMITER_HPP
+
+#include <string>
+#include <deque>
+#include <cstdio>
+
+class RateLimiter {
+public:
+    // Constantes
+    static constexpr size_t TAILLE_FILE = 16;     // Requêtes en attente au maximum
+    static constexpr double DEBIT_DEFAUT = 5.0;   // Requêtes par seconde
+    static constexpr double RAFALE_DEFAUT = 10.0; // Taille du seau de jetons
+    static constexpr int ATTENTE_MAX_MS = 1000;   // Attente maximale renvoyée par pollTimeout
+    static constexpr const char* MESSAGE_OCCUPE = "🤖 occupé, réessayez plus tard\n"; // Réponse de délestage
+
+    // Politique appliquée quand la file est pleine
+    enum class Politique {
+        OCCUPE,     // Répondre "occupé" à l'expéditeur
+        IGNORER,    // Abandonner la requête silencieusement
+        FUSIONNER,  // Abandonner les doublons d'une requête déjà en file
+    };
+
+    // Sort d'une requête soumise
+    enum class Decision {
+        ACCEPTEE,   // À traiter immédiatement
+        EN_FILE,    // Mise en file, à traiter quand un jeton sera disponible
+        OCCUPEE,    // Délestée, l'expéditeur doit être prévenu
+        IGNOREE,    // Délestée silencieusement
+        FUSIONNEE,  // Doublon d'une requête déjà en file
+    };
+
+    // Compteurs
+    unsigned long acceptees = 0;
+    unsigned long occupees = 0;
+    unsigned long ignorees = 0;
+    unsigned long fusionnees = 0;
+
+    // Constructeur
+    RateLimiter(double debit, double rafale, Politique politique);
+
+    // Fonctions
+    Decision submit(const std::string& requete);
+    bool nextReady(std::string& requete);
+    int pollTimeout();
+    void print_stats(FILE* flux) const;
+
+    static bool parsePolitique(const std::string& nom, Politique& politique);
+
+private:
+    double debit;                    // Jetons ajoutés par seconde
+    double rafale;                   // Nombre maximal de jetons
+    double jetons;                   // Jetons disponibles
+    double dernierRemplissage;       // Instant du dernier remplissage (secondes)
+    Politique politique;
+    std::deque<std::string> file;    // Requêtes en attente d'un jeton
+
+    void remplir();
+};
+
+#endif // RATELIMITER_HPP
@@ -0,0 +1,220 @@
+// ResultCache.cpp
+#include "ResultCache.hpp"
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+
+// Événements demandés pour toute surveillance : un même fichier peut servir
+// à plusieurs entrées, chacune filtrant ceux qui la concernent
+static constexpr uint32_t MASQUE_SURVEILLANCE =
+    IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+    IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+// Événements qui invalident toutes les entrées d'une surveillance
+static constexpr uint32_t FIN_SURVEILLANCE = IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT;
+
+/**
+ * @brief Constructeur de la classe ResultCache
+ * @param budget Octets de résultats conservés au maximum
+ */
+ResultCache::ResultCache(size_t budget) : budget(budget) {
+}
+
+/**
+ * @brief Destructeur : retire toutes les surveillances
+ */
+ResultCache::~ResultCache() {
+    if (fd_inotify != -1) close(fd_inotify);
+}
+
+/**
+ * @brief Prépare les surveillances inotify
+ * Sans inotify, rien n'est mis en cache : un résultat ne pourrait pas être invalidé.
+ * @return true si le cache est utilisable
+ */
+bool ResultCache::open() {
+    if (fd_inotify == -1) {
+        fd_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    }
+    return fd_inotify != -1;
+}
+
+/**
+ * @brief Coût d'une entrée dans le budget, structures comprises
+ */
+size_t ResultCache::cost(const Entree& entree) {
+    size_t total = sizeof(Entree) + 64 + entree.cle.size() + entree.valeur.size();
+    for (const Dependance& d : entree.dependances) {
+        total += sizeof(Dependance) + d.nom.size();
+    }
+    return total;
+}
+
+/**
+ * @brief Cherche un résultat
+ * Les événements en attente sont appliqués avant de répondre : une modification
+ * terminée avant la requête n'est jamais masquée par le cache.
+ * @param cle Commande et arguments
+ * @param valeur Résultat trouvé
+ * @return true si le résultat était en cache
+ */
+bool ResultCache::find(const std::string& cle, std::string& valeur) {
+    readEvents();
+    auto it = index.find(cle);
+    if (it == index.end()) {
+        echecs++;
+        return false;
+    }
+    entrees.splice(entrees.begin(), entrees, it->second); // Plus récemment utilisée
+    valeur = it->second->valeur;
+    succes++;
+    return true;
+}
+
+/**
+ * @brief Pose les surveillances d'un résultat avant de le calculer
+ * Une modification pendant le calcul produit alors un événement qui invalidera
+ * le résultat dès son insertion.
+ * @param cle Commande et arguments
+ * @param surveillances Fichiers et dossiers dont dépend le résultat
+ * @return false si le résultat ne peut pas être mis en cache
+ */
+bool ResultCache::reserve(const std::string& cle, const std::vector<Surveillance>& surveillances) {
+    releaseUnused(reservees);
+    reservees.clear();
+    cleReservee.clear();
+    if (fd_inotify == -1 || budget == 0) return false;
+
+    for (const Surveillance& s : surveillances) {
+        int wd = inotify_add_watch(fd_inotify, s.chemin.c_str(), MASQUE_SURVEILLANCE);
+        if (wd == -1) {
+            // Chemin absent ou limite de surveillances atteinte
+            releaseUnused(reservees);
+            reservees.clear();
+            return false;
+        }
+        reservees.push_back({wd, s.nom, s.evenements});
+    }
+    cleReservee = cle;
+    return true;
+}
+
+/**
+ * @brief Ajoute le résultat réservé, en évinçant les moins récemment utilisés
+ * @param cle Commande et arguments, passés à reserve() juste avant
+ * @param valeur Résultat calculé
+ */
+void ResultCache::insert(const std::string& cle, const std::string& valeur) {
+    Entree entree = {cle, valeur, {}};
+    entree.dependances.swap(reservees);
+    bool reservee = cle == cleReservee;
+    cleReservee.clear();
+    if (!reservee || index.count(cle)) {
+        // Sans surveillances, le résultat ne serait jamais invalidé
+        releaseUnused(entree.dependances);
+        return;
+    }
+
+    size_t cout = cost(entree);
+    if (cout > budget) {
+        releaseUnused(entree.dependances);
+        return;
+    }
+
+    // Inscrire les surveillances d'abord, pour que les évictions ne les retirent pas
+    for (const Dependance& d : entree.dependances) {
+        dependants[d.wd].insert(cle);
+    }
+    while (taille + cout > budget && !entrees.empty()) {
+        erase(entrees.back().cle);
+        evictions++;
+    }
+    entrees.push_front(std::move(entree));
+    index[cle] = entrees.begin();
+    taille += cout;
+}
+
+/**
+ * @brief Retire une entrée et les surveillances qui ne servent plus
+ * @param cle Commande et arguments (copiée : elle peut appartenir à l'entrée retirée)
+ */
+void ResultCache::erase(std::string cle) {
+    auto it = index.find(cle);
+    if (it == index.end()) return;
+
+    std::vector<Dependance> dependances = std::move(it->second->dependances);
+    taille -= cost(*it->second);
+    entrees.erase(it->second);
+    index.erase(it);
+
+    for (const Dependance& d : dependances) {
+        auto dep = dependants.find(d.wd);
+        if (dep == dependants.end()) continue;
+        dep->second.erase(cle);
+        if (dep->second.empty()) {
+            inotify_rm_watch(fd_inotify, d.wd);
+            dependants.erase(dep);
+        }
+    }
+}
+
+/**
+ * @brief Retire les surveillances qu'aucune entrée n'utilise
+ */
+void ResultCache::releaseUnused(const std::vector<Dependance>& dependances) {
+    for (const Dependance& d : dependances) {
+        if (!dependants.count(d.wd)) {
+            inotify_rm_watch(fd_inotify, d.wd); // Sans effet si déjà retirée
+        }
+    }
+}
+
+/**
+ * @brief Applique les événements inotify en attente : les entrées concernées sont invalidées
+ */
+void ResultCache::readEvents() {
+    if (fd_inotify == -1) return;
+
+    alignas(struct inotify_event) char evenements[4096];
+    ssize_t n;
+    while ((n = read(fd_inotify, evenements, sizeof(evenements))) > 0) {
+        for (char* p = evenements; p < evenements + n;) {
+            struct inotify_event* evenement = reinterpret_cast<struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + evenement->len;
+
+            if (evenement->mask & IN_Q_OVERFLOW) {
+                // Des événements ont été perdus : plus aucun résultat n'est sûr
+                invalidations += entrees.size();
+                while (!entrees.empty()) erase(entrees.front().cle);
+                continue;
+            }
+            auto dep = dependants.find(evenement->wd);
+            if (dep == dependants.end()) continue;
+
+            bool fin = evenement->mask & FIN_SURVEILLANCE;
+            std::vector<std::string> invalides;
+            for (const std::string& cle : dep->second) {
+                for (const Dependance& d : index[cle]->dependances) {
+                    bool concerne = d.nom.empty() || evenement->len == 0 || d.nom == evenement->name;
+                    if (d.wd == evenement->wd && (fin || ((evenement->mask & d.evenements) && concerne))) {
+                        invalides.push_back(cle);
+                        break;
+                    }
+                }
+            }
+            for (const std::string& cle : invalides) {
+                erase(cle);
+                invalidations++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Affiche les compteurs du cache
+ * @param flux Flux de sortie
+ */
+void ResultCache::print_stats(FILE* flux) const {
+    fprintf(flux, "Cache : %lu succès, %lu échecs, %lu invalidations, %lu évictions, %zu entrées (%zu / %zu octets)\n",
+            succes, echecs, invalidations, evictions, entrees.size(), taille, budget);
+}
@@ -0,0 +1,76 @@
+// ResultCache.hpp
+#ifndef RESULTCACHE_HPP
+#define RESULTCACHE_HPP
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include <cstdio>
+
+class ResultCache {
+public:
+    // Constante
+    static constexpr size_t BUDGET_DEFAUT = 4 << 20; // Octets de résultats conservés au maximum
+
+    // Fichier ou dossier dont dépend un résultat
+    struct Surveillance {
+        std::string chemin;          // Chemin surveillé
+        std::string nom;             // Pour un dossier : seule entrée concernée, vide pour toutes
+        uint32_t evenements;         // Événements inotify qui invalident le résultat
+    };
+
+    // Compteurs
+    unsigned long succes = 0;        // Résultats servis depuis la mémoire
+    unsigned long echecs = 0;        // Résultats à recalculer
+    unsigned long invalidations = 0; // Résultats retirés sur un événement inotify
+    unsigned long evictions = 0;     // Résultats retirés pour respecter le budget
+
+    // Constructeur et destructeur
+    ResultCache(size_t budget);
+    ~ResultCache();
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    // Fonctions
+    bool open();
+    int fd() const { return fd_inotify; }
+    bool find(const std::string& cle, std::string& valeur);
+    bool reserve(const std::string& cle, const std::vector<Surveillance>& surveillances);
+    void insert(const std::string& cle, const std::string& valeur);
+    void readEvents();
+    void print_stats(FILE* flux) const;
+
+private:
+    // Surveillance posée pour une entrée
+    struct Dependance {
+        int wd;                      // Descripteur de surveillance inotify
+        std::string nom;
+        uint32_t evenements;
+    };
+
+    struct Entree {
+        std::string cle;
+        std::string valeur;
+        std::vector<Dependance> dependances;
+    };
+
+    size_t budget;
+    size_t taille = 0;               // Octets occupés par les entrées
+    int fd_inotify = -1;
+
+    std::list<Entree> entrees;       // De la plus récemment utilisée à la plus ancienne
+    std::unordered_map<std::string, std::list<Entree>::iterator> index;  // Entrées par clé
+    std::unordered_map<int, std::unordered_set<std::string>> dependants; // Clés par surveillance
+
+    std::string cleReservee;         // Entrée en cours de calcul
+    std::vector<Dependance> reservees; // Ses surveillances, déjà posées
+
+    void erase(std::string cle);
+    void releaseUnused(const std::vector<Dependance>& dependances);
+    static size_t cost(const Entree& entree);
+};
+
+#endif // RESULTCACHE_HPP
@@ -0,0 +1,318 @@
+// SessionRegistry.cpp
+#include "SessionRegistry.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+
+// Fonction utilisée
+extern double maintenant();
+
+// Identifiant de la disposition de la table en mémoire partagée
+static constexpr uint32_t MAGIC_REGISTRE = 0x43485231; // "CHR1"
+
+// Le mot de contrôle d'une entrée réunit son état (32 bits de poids faible)
+// et sa version (32 bits de poids fort), modifiés ensemble par compare-and-swap
+static uint64_t motControle(uint32_t etat, uint32_t version) {
+    return (static_cast<uint64_t>(version) << 32) | etat;
+}
+static uint32_t etatDe(uint64_t c) { return static_cast<uint32_t>(c); }
+static uint32_t versionDe(uint64_t c) { return static_cast<uint32_t>(c >> 32); }
+
+/**
+ * @brief Hachage FNV-1a de la paire de pseudonymes
+ */
+uint32_t SessionRegistry::hash(const std::string& utilisateur, const std::string& destinataire) {
+    uint32_t h = 2166136261u;
+    for (char c : utilisateur + "-" + destinataire) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Ouvre (et crée au besoin) le registre partagé des sessions
+ * Le registre est facultatif : en cas d'échec, le chat fonctionne sans.
+ * @return true si le registre est utilisable
+ */
+bool SessionRegistry::open() {
+    if (table) return true;
+
+    int fd = shm_open(NOM, O_CREAT | O_RDWR, 0666);
+    if (fd == -1) {
+        return false;
+    }
+    fchmod(fd, 0666); // Partagé entre tous les utilisateurs, malgré l'umask
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 ||
+        (st.st_size < static_cast<off_t>(sizeof(Table)) && ftruncate(fd, sizeof(Table)) == -1)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* ptr = mmap(nullptr, sizeof(Table), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (ptr == MAP_FAILED) {
+        return false;
+    }
+    table = static_cast<Table*>(ptr);
+
+    // Une table neuve est remplie de zéros, c'est-à-dire d'entrées LIBRE
+    uint32_t attendu = 0;
+    __atomic_compare_exchange_n(&table->magic, &attendu, MAGIC_REGISTRE, false,
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&table->magic, __ATOMIC_ACQUIRE) != MAGIC_REGISTRE) {
+        // Disposition inconnue : ne pas y toucher
+        munmap(table, sizeof(Table));
+        table = nullptr;
+        return false;
+    }
+    table->capacite = CAPACITE;
+    return true;
+}
+
+/**
+ * @brief Copie une entrée active sans verrou
+ * La copie n'est retenue que si le mot de contrôle n'a pas changé pendant la lecture.
+ * @return false si l'entrée n'est pas active ou a été modifiée entre-temps
+ */
+bool SessionRegistry::readEntry(size_t index, Session& session, uint32_t& hachage) {
+    Entree& e = table->entrees[index];
+    uint64_t avant = __atomic_load_n(&e.controle, __ATOMIC_ACQUIRE);
+    if (etatDe(avant) != ACTIVE) return false;
+
+    char utilisateur[TAILLE_PSEUDO];
+    char destinataire[TAILLE_PSEUDO];
+    memcpy(utilisateur, e.utilisateur, TAILLE_PSEUDO);
+    memcpy(destinataire, e.destinataire, TAILLE_PSEUDO);
+    utilisateur[TAILLE_PSEUDO - 1] = '\0';
+    destinataire[TAILLE_PSEUDO - 1] = '\0';
+    hachage = e.hachage;
+    session.pid = e.pid;
+    session.mode = e.mode;
+    session.heartbeat = __atomic_load_n(&e.heartbeat, __ATOMIC_RELAXED);
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&e.controle, __ATOMIC_RELAXED) != avant) {
+        return false;
+    }
+    session.utilisateur = utilisateur;
+    session.destinataire = destinataire;
+    session.vivante = false; // Vérifié à part, seulement pour les entrées retenues
+    return true;
+}
+
+/**
+ * @brief Indique si une session est vivante : processus présent et signe de vie récent
+ */
+bool SessionRegistry::isAlive(const Session& session) {
+    bool present = kill(session.pid, 0) == 0 || errno == EPERM;
+    return present && maintenant() - session.heartbeat <= 3 * INTERVALLE_HEARTBEAT;
+}
+
+/**
+ * @brief Cherche l'entrée active d'une paire de pseudonymes
+ * @return Indice de l'entrée, -1 si absente
+ */
+long SessionRegistry::findSlot(const std::string& utilisateur, const std::string& destinataire) {
+    uint32_t h = hash(utilisateur, destinataire);
+    for (size_t i = 0; i < SONDAGE_MAX; ++i) {
+        size_t index = (h + i) % CAPACITE;
+        Entree& e = table->entrees[index];
+        uint64_t c = __atomic_load_n(&e.controle, __ATOMIC_ACQUIRE);
+        if (etatDe(c) == LIBRE) break; // Fin de la chaîne de sondage
+        // Les entrées des autres paires sont écartées sur le hachage, sans copie
+        if (etatDe(c) != ACTIVE || __atomic_load_n(&e.hachage, __ATOMIC_RELAXED) != h) continue;
+
+        Session session;
+        uint32_t hachage;
+        if (readEntry(index, session, hachage) && hachage == h &&
+            session.utilisateur == utilisateur && session.destinataire == destinataire) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Enregistre une session, en remplaçant une éventuelle entrée
+ * précédente pour la même paire de pseudonymes
+ * @return Indice de l'entrée, -1 si le registre est indisponible ou plein
+ */
+long SessionRegistry::add(const std::string& utilisateur, const std::string& destinataire, pid_t pid, uint32_t mode) {
+    if (!table) return -1;
+
+    uint32_t h = hash(utilisateur, destinataire);
+    long existant = findSlot(utilisateur, destinataire);
+
+    // Au plus SONDAGE_MAX entrées, comme les recherches : au-delà, registre plein pour cette paire
+    for (size_t i = 0; i < SONDAGE_MAX; ++i) {
+        size_t index = existant != -1 ? existant : (h + i) % CAPACITE;
+        Entree& e = table->entrees[index];
+        uint64_t* mot = &e.controle;
+        uint64_t c = __atomic_load_n(mot, __ATOMIC_ACQUIRE);
+
+        // Si l'entrée a seulement été libérée entre-temps (reclaim), la reprendre :
+        // passer à la suivante couperait la chaîne de sondage
+        bool reservee = false;
+        uint32_t version = 0;
+        for (int essai = 0; essai < 2 && !reservee; ++essai) {
+            bool reutilisable = (existant != -1 && etatDe(c) == ACTIVE) ||
+                                etatDe(c) == LIBRE || etatDe(c) == SUPPRIMEE;
+            if (!reutilisable) break;
+            version = versionDe(c) + 1;
+            reservee = __atomic_compare_exchange_n(mot, &c, motControle(RESERVEE, version), false,
+                                                   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+            if (!reservee && etatDe(c) != LIBRE) break;
+        }
+        if (reservee) {
+            // Entrée réservée : personne d'autre ne l'écrit
+            e.hachage = h;
+            e.mode = mode;
+            e.pid = pid;
+            __atomic_store_n(&e.heartbeat, static_cast<int64_t>(maintenant()), __ATOMIC_RELAXED);
+            strncpy(e.utilisateur, utilisateur.c_str(), TAILLE_PSEUDO - 1);
+            e.utilisateur[TAILLE_PSEUDO - 1] = '\0';
+            strncpy(e.destinataire, destinataire.c_str(), TAILLE_PSEUDO - 1);
+            e.destinataire[TAILLE_PSEUDO - 1] = '\0';
+            __atomic_store_n(mot, motControle(ACTIVE, version), __ATOMIC_RELEASE);
+            return index;
+        }
+        existant = -1; // Entrée remplacée entre-temps : sonder normalement
+    }
+    return -1;
+}
+
+/**
+ * @brief Retire une session (utilisable depuis un gestionnaire de signal)
+ * @param slot Indice renvoyé par add()
+ * @param pid Processus propriétaire : l'entrée d'une autre session n'est pas retirée
+ */
+void SessionRegistry::remove(long slot, pid_t pid) {
+    if (!table || slot < 0) return;
+    Entree& e = table->entrees[slot];
+    uint64_t* mot = &e.controle;
+    uint64_t c = __atomic_load_n(mot, __ATOMIC_ACQUIRE);
+    if (etatDe(c) != ACTIVE || e.pid != pid) return;
+    // Échoue si l'entrée a été réservée par une autre session entre-temps
+    if (__atomic_compare_exchange_n(mot, &c, motControle(SUPPRIMEE, versionDe(c)), false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        reclaim(slot);
+    }
+}
+
+/**
+ * @brief Libère les entrées supprimées qui terminent une chaîne de sondage
+ * Une entrée suivie d'une entrée LIBRE n'est traversée par aucune recherche
+ * qui aboutit plus loin : elle redevient LIBRE, puis les précédentes de même.
+ * @param index Entrée qui vient d'être supprimée
+ */
+void SessionRegistry::reclaim(size_t index) {
+    for (size_t n = 0; n < SONDAGE_MAX; ++n) {
+        uint64_t* suivant = &table->entrees[(index + 1) % CAPACITE].controle;
+        if (etatDe(__atomic_load_n(suivant, __ATOMIC_ACQUIRE)) != LIBRE) return;
+
+        uint64_t* mot = &table->entrees[index].controle;
+        uint64_t c = __atomic_load_n(mot, __ATOMIC_ACQUIRE);
+        uint64_t libre = motControle(LIBRE, versionDe(c));
+        if (etatDe(c) != SUPPRIMEE ||
+            !__atomic_compare_exchange_n(mot, &c, libre, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return;
+        }
+        if (etatDe(__atomic_load_n(suivant, __ATOMIC_ACQUIRE)) != LIBRE) {
+            // Suivante réservée entre-temps par une paire qui a pu passer ici :
+            // remettre la marque (sauf si l'entrée vient d'être réservée à son tour)
+            __atomic_compare_exchange_n(mot, &libre, c, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+            return;
+        }
+        index = (index + CAPACITE - 1) % CAPACITE;
+    }
+}
+
+/**
+ * @brief Met à jour le signe de vie d'une session (utilisable depuis un gestionnaire de signal)
+ * @param slot Indice renvoyé par add()
+ * @param pid Processus propriétaire
+ */
+void SessionRegistry::heartbeat(long slot, pid_t pid) {
+    if (!table || slot < 0) return;
+    Entree& e = table->entrees[slot];
+    uint64_t c = __atomic_load_n(&e.controle, __ATOMIC_ACQUIRE);
+    if (etatDe(c) == ACTIVE && e.pid == pid) {
+        __atomic_store_n(&e.heartbeat, static_cast<int64_t>(maintenant()), __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief Cherche une session par paire de pseudonymes, en O(1) en moyenne
+ * @param session Session trouvée
+ * @return true si la session est enregistrée
+ */
+bool SessionRegistry::find(const std::string& utilisateur, const std::string& destinataire, Session& session) {
+    if (!table) return false;
+    long index = findSlot(utilisateur, destinataire);
+    uint32_t hachage;
+    if (index == -1 || !readEntry(index, session, hachage)) return false;
+    session.vivante = isAlive(session);
+    return true;
+}
+
+/**
+ * @brief Liste les sessions enregistrées
+ * Les entrées dont le processus n'existe plus sont retirées au passage.
+ */
+std::vector<SessionRegistry::Session> SessionRegistry::list() {
+    std::vector<Session> sessions;
+    if (!table) return sessions;
+    for (size_t index = 0; index < CAPACITE; ++index) {
+        Session session;
+        uint32_t hachage;
+        if (!readEntry(index, session, hachage)) continue;
+        if (kill(session.pid, 0) == -1 && errno == ESRCH) {
+            remove(index, session.pid); // Processus terminé sans se désinscrire
+            continue;
+        }
+        session.vivante = isAlive(session);
+        sessions.push_back(session);
+    }
+    return sessions;
+}
+
+/**
+ * @brief Affiche les sessions en cours (chat --who [pseudo])
+ * @param filtre Pseudonyme dont on veut les sessions, vide pour toutes
+ * @return Code de retour du programme
+ */
+int SessionRegistry::printWho(const std::string& filtre) {
+    SessionRegistry registre;
+    if (!registre.open()) {
+        fprintf(stderr, "Erreur : registre des sessions indisponible.\n");
+        return 1;
+    }
+
+    for (const Session& s : registre.list()) {
+        if (!filtre.empty() && s.utilisateur != filtre && s.destinataire != filtre) continue;
+
+        std::string mode;
+        if (s.mode & MODE_BOT) mode += " --bot";
+        if (s.mode & MODE_MANUEL) mode += " --manuel";
+        if (s.mode & MODE_JOLI) mode += " --joli";
+
+        const char* etat = "inactif";
+        if (s.vivante) {
+            Session autre;
+            bool connecte = registre.find(s.destinataire, s.utilisateur, autre) && autre.vivante;
+            etat = connecte ? "connecté" : "en attente";
+        }
+        printf("%s -> %s (pid %d%s) %s, dernier signe de vie il y a %ld s\n",
+               s.utilisateur.c_str(), s.destinataire.c_str(), static_cast<int>(s.pid),
+               mode.c_str(), etat, static_cast<long>(maintenant() - s.heartbeat));
+    }
+    return 0;
+}
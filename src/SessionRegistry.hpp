@@ -0,0 +1,80 @@
+// SessionRegistry.hpp
+#ifndef SESSIONREGISTRY_HPP
+#define SESSIONREGISTRY_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <sys/types.h>
+
+class SessionRegistry {
+public:
+    // Constantes
+    static constexpr size_t CAPACITE = 4096;           // Sessions simultanées au maximum
+    static constexpr size_t SONDAGE_MAX = 64;          // Entrées examinées au plus pour une paire
+    static constexpr size_t TAILLE_PSEUDO = 32;        // Pseudonyme (30 caractères) et '\0'
+    static constexpr int INTERVALLE_HEARTBEAT = 5;     // Secondes entre deux signes de vie
+    static constexpr const char* NOM = "/chat_registry"; // Nom de la mémoire partagée
+
+    // Options de la session
+    enum Mode : uint32_t {
+        MODE_BOT = 1,
+        MODE_MANUEL = 2,
+        MODE_JOLI = 4,
+    };
+
+    // Copie d'une session lue dans le registre
+    struct Session {
+        std::string utilisateur;
+        std::string destinataire;
+        pid_t pid;
+        uint32_t mode;
+        int64_t heartbeat;           // Dernier signe de vie (secondes, horloge monotone)
+        bool vivante;                // Processus présent et signe de vie récent
+    };
+
+    // Fonctions
+    bool open();
+    long add(const std::string& utilisateur, const std::string& destinataire, pid_t pid, uint32_t mode);
+    void remove(long slot, pid_t pid);
+    void heartbeat(long slot, pid_t pid);
+    bool find(const std::string& utilisateur, const std::string& destinataire, Session& session);
+    std::vector<Session> list();
+
+    static int printWho(const std::string& filtre);
+
+private:
+    // États d'une entrée
+    enum Etat : uint32_t {
+        LIBRE = 0,                   // Jamais utilisée ou libérée : fin des sondages
+        RESERVEE = 1,                // En cours d'écriture par un processus
+        ACTIVE = 2,
+        SUPPRIMEE = 3,               // Réutilisable, mais les sondages continuent
+    };
+
+    struct Entree {
+        uint64_t controle;           // État et version, incrémentée à chaque réservation
+        uint32_t hachage;
+        uint32_t mode;
+        int32_t pid;
+        int64_t heartbeat;
+        char utilisateur[TAILLE_PSEUDO];
+        char destinataire[TAILLE_PSEUDO];
+    };
+
+    struct Table {
+        uint32_t magic;
+        uint32_t capacite;
+        Entree entrees[CAPACITE];
+    };
+
+    Table* table = nullptr;          // Projection de la mémoire partagée
+
+    static uint32_t hash(const std::string& utilisateur, const std::string& destinataire);
+    bool readEntry(size_t index, Session& session, uint32_t& hachage);
+    static bool isAlive(const Session& session);
+    void reclaim(size_t index);
+    long findSlot(const std::string& utilisateur, const std::string& destinataire);
+};
+
+#endif // SESSIONREGISTRY_HPP
@@ -7,11 +7,13 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include "Tui.hpp"
 
 // Déclaration des variables globales utilisées
 extern bool isBotMode;
 extern std::string pseudo_destinataire;
 extern std::string texte_a_print(std::string pseudo);
+extern Tui* tui;
 
 /**
  * @brief Constructeur de la classe SharedMemory
@@ -98,33 +100,54 @@ void SharedMemory::release_shared_memory(bool isParent) {
 
 /**
  * @brief Écrit un message dans la mémoire partagée
+ * Seul le processus enfant écrit ; l'offset n'est publié qu'une fois le message
+ * copié, et la copie est refaite au début si le parent a vidé la mémoire entre-temps.
  * @param message Le message à écrire
  */
 void SharedMemory::write_to_shared_memory(const std::string& message) {
     size_t message_length = message.size() + 1; // Taille du message avec le caractère nul
-    if (*shm_offset_ptr + message_length > SHM_SIZE - sizeof(size_t)) {
-        // Mémoire pleine, réinitialiser
-        *shm_offset_ptr = 0;
+    size_t offset = __atomic_load_n(shm_offset_ptr, __ATOMIC_ACQUIRE);
+    for (;;) {
+        // Mémoire pleine, réinitialiser (évité en attendant l'affichage, voir has_room)
+        size_t debut = offset + message_length <= SHM_SIZE - sizeof(size_t) ? offset : 0;
+        memcpy(shm_ptr + sizeof(size_t) + debut, message.c_str(), message_length); // Copie du message dans la mémoire partagée
+        if (__atomic_compare_exchange_n(shm_offset_ptr, &offset, debut + message_length,
+                                        false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+            return; // Mise à jour de l'offset
+        }
     }
+}
 
-    char* shm_data = shm_ptr + sizeof(size_t) + *shm_offset_ptr;
-    memcpy(shm_data, message.c_str(), message_length); // Copie du message dans la mémoire partagée
-    *shm_offset_ptr += message_length; // Mise à jour de l'offset
+/**
+ * @brief Indique si un message tient dans la mémoire partagée
+ * @param message_length Taille du message avec le caractère nul
+ */
+bool SharedMemory::has_room(size_t message_length) const {
+    return __atomic_load_n(shm_offset_ptr, __ATOMIC_ACQUIRE) + message_length <= SHM_SIZE - sizeof(size_t);
 }
 
 /**
  * @brief Affiche les messages en attente depuis la mémoire partagée
+ * Appelée hors des gestionnaires de signaux ; la remise à zéro échoue si
+ * l'enfant a ajouté un message pendant l'affichage, qui est alors affiché aussi.
  */
 void SharedMemory::output_shared_memory() {
     size_t offset = 0;
     char* shm_data = shm_ptr + sizeof(size_t);
-    while (offset < *shm_offset_ptr) {
-        // Affichage des messages
-        printf(isBotMode ? "[%s] %s" : texte_a_print(pseudo_destinataire).c_str(),
-               pseudo_destinataire.c_str(), (shm_data + offset));
-        offset += strlen(shm_data + offset) + 1;
-    }
-    // Réinitialisation de la mémoire partagée
-    memset(shm_ptr + sizeof(size_t), 0, SHM_SIZE - sizeof(size_t));
-    *shm_offset_ptr = 0;
+    size_t fin = __atomic_load_n(shm_offset_ptr, __ATOMIC_ACQUIRE);
+    do {
+        if (fin < offset) offset = 0; // Mémoire réinitialisée par l'enfant
+        while (offset < fin) {
+            // Affichage des messages
+            if (tui) {
+                tui->addMessage(pseudo_destinataire, shm_data + offset);
+            } else {
+                printf(isBotMode ? "[%s] %s" : texte_a_print(pseudo_destinataire).c_str(),
+                       pseudo_destinataire.c_str(), (shm_data + offset));
+            }
+            offset += strlen(shm_data + offset) + 1;
+        }
+        // Réinitialisation de la mémoire partagée
+    } while (!__atomic_compare_exchange_n(shm_offset_ptr, &fin, 0,
+                                          false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
 }
@@ -6,8 +6,9 @@
 
 class SharedMemory {
 public:
-    // Constante
+    // Constantes
     static constexpr size_t SHM_SIZE = 4096; // Taille de la mémoire partagée
+    static constexpr int ATTENTE_AFFICHAGE_MS = 10; // Entre deux vérifications d'une mémoire pleine
 
     // Variables membres
     char* shm_ptr = nullptr;         // Pointeur vers la mémoire partagée
@@ -23,6 +24,7 @@ public:
     void release_shared_memory(bool isParent);
     void output_shared_memory();
     void write_to_shared_memory(const std::string& message);
+    bool has_room(size_t message_length) const;
 };
 
 #endif // SHAREDMEMORY_HPP
@@ -5,6 +5,7 @@
 #include <unistd.h>
 #include <sys/wait.h>
 #include <iostream>
+#include "Tui.hpp"
 
 // Définition des variables statiques
 SharedMemory* SignalHandler::sharedMemory = nullptr;
@@ -15,10 +16,14 @@ extern bool pipesOuverts;
 extern bool isManuelMode;
 extern bool isBotMode;
 extern int fd_send;
+extern int fd_ctrl_send;
 extern pid_t pid;
 extern volatile sig_atomic_t should_exit;
 extern std::string pseudo_destinataire;
 extern std::string texte_a_print(std::string pseudo);
+extern Tui* tui;
+extern volatile sig_atomic_t tui_redimensionner;
+extern volatile sig_atomic_t flush_demande;
 
 /**
  * @brief Initialise les pointeurs vers SharedMemory et Pipes
@@ -40,11 +45,16 @@ void SignalHandler::handleSIGINT(int signal) {
             // Les pipes n'ont pas été ouverts, terminer avec le code de retour 4
             exit(4);
         } else if (isManuelMode && sharedMemory) {
-            sharedMemory->output_shared_memory(); // Afficher les messages en attente
+            flush_demande = 1; // Messages en attente affichés hors du gestionnaire
         } else {
+            // Quitter l'interface pour que le message reste visible
+            if (tui) tui->stop();
             // Terminer le programme proprement avec un message
             fprintf(stderr, "\n\033[33mWARNING\033[0m Utilisateur déconnecté.\n");
+            // Prévenir l'autre utilisateur par le canal de contrôle
+            Pipes::sendControl(fd_ctrl_send, TypeControle::DISCONNECT);
             // Fermer les descripteurs de fichiers et envoyer un signal au processus enfant
+            if (fd_ctrl_send != -1) close(fd_ctrl_send);
             if (fd_send != -1) close(fd_send);
             kill(pid, SIGTERM); // Envoyer SIGTERM au processus enfant
             // Attendre la fin du processus enfant
@@ -79,9 +89,8 @@ void SignalHandler::handleSIGPIPE(int signal) {
  * @param signal Le numéro du signal reçu
  */
 void SignalHandler::handleSIGUSR1(int) {
-    if (isManuelMode && sharedMemory) {
-        sharedMemory->output_shared_memory(); // Afficher les messages en attente
-    }
+    // Messages en attente (ou compteurs du serveur de bot) affichés hors du gestionnaire
+    flush_demande = 1;
 }
 
 /**
@@ -93,30 +102,22 @@ void SignalHandler::handleSIGTERM(int /*signal*/) {
 }
 
 /**
- * @brief Gestionnaire pour SIGUSR2 dans le processus parent
+ * @brief Gestionnaire pour SIGWINCH dans le processus parent
  * @param signal Le numéro du signal reçu
  */
-void SignalHandler::handleSIGUSR2(int signal) {
-    if (signal == SIGUSR2) {
-        // L'autre utilisateur s'est déconnecté
-        if (!isManuelMode) {
-            // En mode normal, terminer le programme proprement
-            if (fd_send != -1) close(fd_send);
-            if (pid > 0) {
-                kill(pid, SIGTERM);
-                wait(nullptr);
-            }
-            if (pipes) {
-                pipes->unlink_pipes();
-            }
-            if (isManuelMode && sharedMemory) {
-                sharedMemory->release_shared_memory(true);
-                delete sharedMemory;
-                sharedMemory = nullptr;
-            }
-            exit(0);
-        } else {
-            // En mode manuel, ne pas terminer le programme
-        }
+void SignalHandler::handleSIGWINCH(int /*signal*/) {
+    tui_redimensionner = 1; // L'interface relira la taille du terminal
+}
+
+/**
+ * @brief Gestionnaire pour SIGALRM dans le processus parent : signe de vie périodique
+ * @param signal Le numéro du signal reçu
+ */
+void SignalHandler::handleSIGALRM(int /*signal*/) {
+    if (pipes) {
+        pipes->heartbeat(); // Registre des sessions
     }
+    // Signe de vie pour l'autre utilisateur, sur le canal de contrôle
+    Pipes::sendControl(fd_ctrl_send, TypeControle::HEARTBEAT);
+    alarm(SessionRegistry::INTERVALLE_HEARTBEAT);
 }
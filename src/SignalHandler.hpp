@@ -13,7 +13,8 @@ public:
     static void handleSIGPIPE(int signal);
     static void handleSIGUSR1(int signal);
     static void handleSIGTERM(int signal);
-    static void handleSIGUSR2(int signal);
+    static void handleSIGWINCH(int signal);
+    static void handleSIGALRM(int signal);
 
     // Méthode pour initialiser les pointeurs
     static void init(SharedMemory* sharedMemoryPtr, Pipes* pipesPtr);
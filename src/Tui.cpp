@@ -0,0 +1,313 @@
+// Tui.cpp
+#include "Tui.hpp"
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <errno.h>
+
+// Fonction utilisée
+extern std::string getColorCode(const std::string& pseudo);
+extern double maintenant();
+
+/**
+ * @brief Écrit l'intégralité d'une chaîne sur la sortie standard
+ * @param texte Données à écrire
+ */
+static void ecrire(const std::string& texte) {
+    size_t total = 0;
+    while (total < texte.size()) {
+        ssize_t n = write(STDOUT_FILENO, texte.data() + total, texte.size() - total);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        total += n;
+    }
+}
+
+/**
+ * @brief Indique si un octet commence un caractère UTF-8 (une colonne à l'affichage)
+ */
+static bool debutCaractere(unsigned char c) {
+    return (c & 0xC0) != 0x80;
+}
+
+/**
+ * @brief Passe le terminal en mode interface : saisie caractère par caractère,
+ * sans écho, sur l'écran alternatif
+ * @return false si le terminal ne peut pas être configuré
+ */
+bool Tui::start() {
+    if (tcgetattr(STDIN_FILENO, &ancien) == -1) {
+        return false;
+    }
+    struct termios brut = ancien;
+    // ISIG est conservé : Ctrl+C reste géré par handleSIGINT
+    brut.c_lflag &= ~(ICANON | ECHO | ECHOCTL);
+    brut.c_cc[VMIN] = 1;
+    brut.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &brut) == -1) {
+        return false;
+    }
+    actif = true;
+    ecrire("\033[?1049h");
+    resize();
+    return true;
+}
+
+/**
+ * @brief Restaure le terminal (appelable depuis un gestionnaire de signal)
+ */
+void Tui::stop() {
+    if (!actif) return;
+    actif = false;
+    static const char quitter[] = "\033[?1049l";
+    if (write(STDOUT_FILENO, quitter, sizeof(quitter) - 1) == -1) {
+        // Rien à faire : le terminal est restauré ci-dessous malgré tout
+    }
+    tcsetattr(STDIN_FILENO, TCSANOW, &ancien);
+}
+
+/**
+ * @brief Relit la taille du terminal et force un rafraîchissement complet
+ */
+void Tui::resize() {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 1 && ws.ws_col > 4) {
+        lignes = ws.ws_row;
+        colonnes = ws.ws_col;
+    }
+    // Contenu impossible : toutes les rangées seront réécrites
+    ecran.assign(lignes, std::string(1, '\001'));
+    ecrire("\033[2J");
+    sale = true;
+    derniereImage = 0;
+}
+
+/**
+ * @brief Ajoute un message à l'historique ; l'affichage est différé à render()
+ * @param pseudo Auteur du message
+ * @param texte Texte du message
+ */
+void Tui::addMessage(const std::string& pseudo, const std::string& texte) {
+    // Les caractères de contrôle reçus ne doivent pas piloter le terminal
+    std::string propre;
+    for (char c : texte) {
+        if (c == '\n') {
+            continue;
+        }
+        propre += (static_cast<unsigned char>(c) < 0x20 || c == 0x7f) ? '?' : c;
+    }
+    historique.push_back("[" + getColorCode(pseudo) + pseudo + "\033[0m] " + propre);
+    if (historique.size() > TAILLE_HISTORIQUE) {
+        historique.pop_front();
+    }
+    if (defilement > 0) {
+        defilement++; // Garder la même vue pendant la lecture de l'historique
+    }
+    sale = true;
+}
+
+/**
+ * @brief Lit les touches disponibles sur l'entrée standard
+ * @return false en fin de saisie (Ctrl+D sur une ligne vide ou fin de stdin)
+ */
+bool Tui::readInput() {
+    char tampon[256];
+    ssize_t n = read(STDIN_FILENO, tampon, sizeof(tampon));
+    if (n == 0) {
+        finSaisie = true;
+    } else if (n == -1) {
+        return errno == EINTR || errno == EAGAIN;
+    }
+
+    for (ssize_t i = 0; i < n; ++i) {
+        unsigned char c = tampon[i];
+        if (etatEchappement == 1) {
+            etatEchappement = (c == '[') ? 2 : 0;
+            continue;
+        }
+        if (etatEchappement == 2) {
+            if (c >= 0x40 && c <= 0x7e) {
+                sequence += c;
+                handleSequence();
+                etatEchappement = 0;
+                sequence.clear();
+            } else {
+                sequence += c;
+            }
+            continue;
+        }
+
+        if (c == 0x1b) {
+            etatEchappement = 1;
+        } else if (c == '\r' || c == '\n') {
+            lignesPretes.push_back(saisie + "\n");
+            saisie.clear();
+            defilement = 0;
+        } else if (c == 0x7f || c == 0x08) {
+            // Effacer le dernier caractère UTF-8 complet
+            while (!saisie.empty()) {
+                unsigned char dernier = saisie.back();
+                saisie.pop_back();
+                if (debutCaractere(dernier)) break;
+            }
+        } else if (c == 0x15) {
+            saisie.clear(); // Ctrl+U
+        } else if (c == 0x04) {
+            if (saisie.empty()) finSaisie = true; // Ctrl+D
+        } else if (c >= 0x20 && saisie.size() < TAILLE_SAISIE) {
+            saisie += c;
+        }
+    }
+    sale = true;
+    return !finSaisie;
+}
+
+/**
+ * @brief Traite une séquence d'échappement complète (Page précédente / suivante)
+ */
+void Tui::handleSequence() {
+    size_t page = lignes > 2 ? lignes - 2 : 1;
+    if (sequence == "5~") {
+        defilement += page; // Borné par render() à la taille de l'historique
+    } else if (sequence == "6~") {
+        defilement = defilement > page ? defilement - page : 0;
+    }
+    sale = true;
+}
+
+/**
+ * @brief Retire la prochaine ligne validée par l'utilisateur
+ * @param ligne Ligne saisie, terminée par '\n'
+ * @return true si une ligne était disponible
+ */
+bool Tui::nextLine(std::string& ligne) {
+    if (lignesPretes.empty()) return false;
+    ligne = std::move(lignesPretes.front());
+    lignesPretes.pop_front();
+    return true;
+}
+
+/**
+ * @brief Délai d'attente à passer à poll()
+ * @return Millisecondes avant le prochain rafraîchissement autorisé, -1 si rien à afficher
+ */
+int Tui::pollTimeout() const {
+    if (!sale) return -1;
+    double reste = derniereImage + 1.0 / IMAGES_PAR_SECONDE - maintenant();
+    return reste > 0 ? static_cast<int>(reste * 1000) + 1 : 0;
+}
+
+/**
+ * @brief Découpe une ligne mise en forme en rangées de la largeur du terminal
+ * Les séquences d'échappement n'occupent pas de colonne.
+ * @param ligne Ligne à découper
+ */
+std::vector<std::string> Tui::wrap(const std::string& ligne) const {
+    std::vector<std::string> rangees(1);
+    int colonne = 0;
+    for (size_t i = 0; i < ligne.size(); ++i) {
+        unsigned char c = ligne[i];
+        if (c == 0x1b) {
+            // Recopier la séquence jusqu'à son octet final
+            size_t fin = i + 1;
+            while (fin < ligne.size() && !(ligne[fin] >= 0x40 && ligne[fin] <= 0x7e && ligne[fin] != '[')) {
+                fin++;
+            }
+            rangees.back().append(ligne, i, fin - i + 1);
+            i = fin;
+            continue;
+        }
+        if (debutCaractere(c)) {
+            if (colonne == colonnes) {
+                rangees.emplace_back();
+                colonne = 0;
+            }
+            colonne++;
+        }
+        rangees.back() += c;
+    }
+    return rangees;
+}
+
+/**
+ * @brief Construit la rangée de saisie, tronquée par la gauche si nécessaire
+ * @param curseur Colonne du curseur (à partir de 1)
+ */
+std::string Tui::inputRow(int& curseur) const {
+    if (!annonce.empty()) {
+        curseur = 1;
+        return annonce;
+    }
+    size_t debut = 0;
+    int largeur = 0;
+    for (unsigned char c : saisie) {
+        if (debutCaractere(c)) largeur++;
+    }
+    // Garder la fin de la saisie visible
+    while (largeur > colonnes - 3 && debut < saisie.size()) {
+        debut++;
+        while (debut < saisie.size() && !debutCaractere(saisie[debut])) debut++;
+        largeur--;
+    }
+    curseur = 3 + largeur;
+    return "> " + saisie.substr(debut);
+}
+
+/**
+ * @brief Remplace la rangée de saisie par une annonce (fin de conversation)
+ * @param texte Annonce à afficher
+ */
+void Tui::announce(const std::string& texte) {
+    annonce = texte;
+    sale = true;
+}
+
+/**
+ * @brief Rafraîchit l'écran, au plus IMAGES_PAR_SECONDE fois par seconde
+ * Seules les rangées visibles sont construites, et seules celles qui ont
+ * changé depuis l'image précédente sont envoyées au terminal.
+ * @param forcer Ignorer la limite de fréquence (dernière image)
+ */
+void Tui::render(bool forcer) {
+    if (!actif || !sale) return;
+    double t = maintenant();
+    if (!forcer && t - derniereImage < 1.0 / IMAGES_PAR_SECONDE) return;
+
+    size_t hauteur = lignes - 1;
+
+    // Parcourir l'historique depuis la fin jusqu'à remplir la vue
+    std::vector<std::string> rangees; // De la plus récente à la plus ancienne
+    size_t besoin = hauteur + defilement;
+    for (auto it = historique.rbegin(); it != historique.rend() && rangees.size() < besoin; ++it) {
+        std::vector<std::string> decoupe = wrap(*it);
+        for (auto r = decoupe.rbegin(); r != decoupe.rend() && rangees.size() < besoin; ++r) {
+            rangees.push_back(*r);
+        }
+    }
+    if (rangees.size() < besoin) {
+        // Début de l'historique atteint
+        defilement = rangees.size() > hauteur ? rangees.size() - hauteur : 0;
+    }
+
+    std::vector<std::string> cible(lignes);
+    for (size_t i = 0; i < hauteur; ++i) {
+        size_t index = defilement + (hauteur - 1 - i);
+        if (index < rangees.size()) cible[i] = rangees[index];
+    }
+    int curseur;
+    cible[lignes - 1] = inputRow(curseur);
+
+    std::string sortie;
+    for (int i = 0; i < lignes; ++i) {
+        if (ecran[i] != cible[i]) {
+            sortie += "\033[" + std::to_string(i + 1) + ";1H" + cible[i] + "\033[0m\033[K";
+            ecran[i] = std::move(cible[i]);
+        }
+    }
+    sortie += "\033[" + std::to_string(lignes) + ";" + std::to_string(curseur) + "H";
+    ecrire(sortie); // Une seule écriture par image
+
+    sale = false;
+    derniereImage = t;
+}
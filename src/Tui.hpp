@@ -0,0 +1,53 @@
+// Tui.hpp
+#ifndef TUI_HPP
+#define TUI_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <termios.h>
+
+class Tui {
+public:
+    // Constantes
+    static constexpr size_t TAILLE_HISTORIQUE = 1000; // Messages conservés pour le défilement
+    static constexpr int IMAGES_PAR_SECONDE = 30;     // Fréquence maximale de rafraîchissement
+    static constexpr size_t TAILLE_SAISIE = 254;      // Octets saisis au maximum (hors '\n')
+
+    // Fonctions
+    bool start();
+    void stop();
+    void resize();
+    void addMessage(const std::string& pseudo, const std::string& texte);
+    bool readInput();
+    bool nextLine(std::string& ligne);
+    int pollTimeout() const;
+    void render(bool forcer = false);
+    void announce(const std::string& texte);
+
+private:
+    bool actif = false;              // Terminal configuré par l'interface
+    struct termios ancien;           // Attributs du terminal à restaurer
+    int lignes = 24;                 // Hauteur du terminal
+    int colonnes = 80;               // Largeur du terminal
+
+    std::deque<std::string> historique; // Messages déjà mis en forme
+    size_t defilement = 0;           // Rangées remontées depuis le bas
+    std::string saisie;              // Ligne en cours de saisie
+    std::deque<std::string> lignesPretes; // Lignes validées, pas encore envoyées
+    std::string annonce;             // Affichée à la place de la saisie si non vide
+    bool finSaisie = false;          // Ctrl+D sur une ligne vide ou fin de stdin
+
+    std::vector<std::string> ecran; // Rangées actuellement affichées
+    bool sale = false;               // Un rafraîchissement est nécessaire
+    double derniereImage = 0;        // Instant du dernier rafraîchissement (secondes)
+
+    int etatEchappement = 0;         // Analyse des séquences d'échappement du clavier
+    std::string sequence;
+
+    std::vector<std::string> wrap(const std::string& ligne) const;
+    std::string inputRow(int& curseur) const;
+    void handleSequence();
+};
+
+#endif // TUI_HPP
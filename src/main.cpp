@@ -12,12 +12,19 @@
 #include <csignal>
 #include <sys/mman.h>
 #include <errno.h>
+#include <poll.h>
+#include <ctime>
 #include <termios.h> // Pour --joli
 
 #include "SignalHandler.hpp"
 #include "SharedMemory.hpp"
 #include "Pipes.hpp"
 #include "ParameterValidator.hpp"
+#include "RateLimiter.hpp"
+#include "ResultCache.hpp"
+#include "SessionRegistry.hpp"
+#include "BotServer.hpp"
+#include "Tui.hpp"
 
 using namespace std;
 
@@ -26,9 +33,25 @@ bool pipesOuverts = false;       // Indique si les pipes ont été ouverts
 bool isManuelMode = false;       // Mode manuel activé ou non
 bool isBotMode = false;          // Mode bot activé ou non
 bool isJoliMode = false;         // Mode joli activé ou non
+bool isLimiteMode = false;       // Limitation des requêtes demandée (--debit, --rafale, --delestage)
+bool isUringMode = false;        // Backend io_uring demandé ou non
+bool isServeurMode = false;      // Serveur de bot (chat --serveur) au lieu d'une discussion
+bool isWhoMode = false;          // Liste des sessions (chat --who) au lieu d'une discussion
+
+double botDebit = RateLimiter::DEBIT_DEFAUT;   // Requêtes par seconde acceptées en mode bot
+double botRafale = RateLimiter::RAFALE_DEFAUT; // Rafale acceptée en mode bot
+RateLimiter::Politique botPolitique = RateLimiter::Politique::OCCUPE; // Délestage en mode bot
+size_t botCache = ResultCache::BUDGET_DEFAUT;  // Budget du cache de résultats du serveur de bot
 
 int fd_receive = -1;             // Descripteur du pipe de réception
 int fd_send = -1;                // Descripteur du pipe d'envoi
+int fd_ctrl_receive = -1;        // Descripteur du pipe de contrôle de réception
+int fd_ctrl_send = -1;           // Descripteur du pipe de contrôle d'envoi
+int fd_tui_send = -1;            // Transmission des messages reçus à l'interface (--joli)
+
+Tui* tui = nullptr;              // Interface plein écran, dans le processus parent
+volatile sig_atomic_t tui_redimensionner = 0; // SIGWINCH reçu
+volatile sig_atomic_t flush_demande = 0;      // Affichage des messages en attente demandé
 string sendPipe;                 // Nom du pipe d'envoi
 string receivePipe;              // Nom du pipe de réception
 
@@ -63,8 +86,12 @@ const vector<string> color_codes = {
 bool containsChar(const string& str, char ch);
 string texte_a_print(string pseudo);
 string getColorCode(const string& pseudo);
-ssize_t safeWrite(int fd, const void* buf, size_t count);
-ssize_t safeReadMessage(int fd, char* buffer, size_t max_size);
+void delivrer_message(const char* message, SharedMemory* sharedMemory);
+bool traiter_controle_interne(int& fd_interne, Pipes& pipes, SharedMemory* sharedMemory);
+bool extraire_ligne(char* saisie, size_t& debut, size_t& fin, bool finEntree, char* ligne, size_t taille);
+bool envoyer_saisie(const char* buffer, Pipes& pipes, SharedMemory* sharedMemory);
+void restaurer_terminal();
+double maintenant();
 
 int main(int argc, char* argv[]) {
     // Création des instances des classes
@@ -75,6 +102,14 @@ int main(int argc, char* argv[]) {
     // Vérification des paramètres du programme
     paramValidator.checkParams(argc, argv);
 
+    // Modes sans discussion
+    if (isWhoMode) {
+        return SessionRegistry::printWho(pseudo_utilisateur);
+    }
+    if (isServeurMode) {
+        return BotServer(pseudo_utilisateur).run();
+    }
+
     // Construction des noms des pipes
     sendPipe = "/tmp/" + pseudo_utilisateur + "-" + pseudo_destinataire + ".chat";
     receivePipe = "/tmp/" + pseudo_destinataire + "-" + pseudo_utilisateur + ".chat";
@@ -88,6 +123,15 @@ int main(int argc, char* argv[]) {
     // Création des pipes nommés
     pipes.createPipe(sendPipe);
     pipes.createPipe(receivePipe);
+    pipes.createPipe(pipes.sendCtrlPipe);
+    pipes.createPipe(pipes.receiveCtrlPipe);
+
+    // Inscription dans le registre partagé des sessions (chat --who)
+    uint32_t mode = 0;
+    if (isBotMode) mode |= SessionRegistry::MODE_BOT;
+    if (isManuelMode) mode |= SessionRegistry::MODE_MANUEL;
+    if (isJoliMode) mode |= SessionRegistry::MODE_JOLI;
+    pipes.register_session(mode);
 
     // Initialisation de la mémoire partagée avant le fork
     if (isManuelMode) {
@@ -100,6 +144,29 @@ int main(int argc, char* argv[]) {
     // Initialiser SignalHandler avec les instances
     SignalHandler::init(sharedMemory, &pipes);
 
+    // En mode joli sur un terminal, seul le parent dessine l'écran : l'enfant
+    // lui transmet les messages reçus par un pipe anonyme
+    int fd_tui[2] = {-1, -1};
+    if (isJoliMode && !isBotMode && isatty(STDIN_FILENO) && isatty(STDOUT_FILENO)) {
+        if (pipe(fd_tui) == -1) {
+            perror("Erreur lors de la création du pipe de l'interface");
+            fd_tui[0] = fd_tui[1] = -1;
+        }
+    }
+
+    // Canal de contrôle interne : le processus enfant y annonce au parent la
+    // mémoire partagée pleine et le départ de l'autre utilisateur
+    int fd_interne[2];
+    if (pipe(fd_interne) == -1) {
+        perror("Erreur lors de la création du canal de contrôle interne");
+        if (isManuelMode) {
+            sharedMemory->release_shared_memory(true);
+            delete sharedMemory;
+            sharedMemory = nullptr;
+        }
+        exit(1);
+    }
+
     pid = fork(); // Création du processus enfant
     if (pid < 0) {
         perror("Erreur lors de la création du processus");
@@ -111,6 +178,10 @@ int main(int argc, char* argv[]) {
         exit(1);
     } else if (pid == 0) {
         // === Processus enfant ===
+        if (fd_tui[0] != -1) close(fd_tui[0]);
+        fd_tui_send = fd_tui[1];
+        close(fd_interne[0]);
+        int fd_ctrl_parent = fd_interne[1];
 
         // Ouverture de la mémoire partagée existante en mode manuel
         if (isManuelMode) {
@@ -120,6 +191,7 @@ int main(int argc, char* argv[]) {
         }
 
         signal(SIGINT, SIG_IGN); // Ignorer SIGINT dans le processus enfant
+        signal(SIGPIPE, SIG_IGN); // Réponse "occupé" à un utilisateur déjà parti
         signal(SIGTERM, SignalHandler::handleSIGTERM); // Gestionnaire pour SIGTERM
         signal(SIGUSR1, SignalHandler::handleSIGUSR1); // Gestionnaire pour SIGUSR1
 
@@ -129,34 +201,110 @@ int main(int argc, char* argv[]) {
             perror("Erreur lors de l'ouverture du pipe de réception");
             exit(1);
         }
+        // Ouverture du pipe de contrôle, dans le même ordre que l'autre utilisateur
+        fd_ctrl_receive = open(pipes.receiveCtrlPipe.c_str(), O_RDONLY);
+        if (fd_ctrl_receive < 0) {
+            perror("Erreur lors de l'ouverture du pipe de contrôle de réception");
+            exit(1);
+        }
         pipesOuverts = true;
+        pipes.initialize_io(isUringMode); // Le repli éventuel est signalé par le parent
+
+        // En mode bot, limitation du débit des requêtes de l'autre utilisateur, sur demande
+        // seulement : un client en mode bot ne doit pas perdre de messages par défaut
+        RateLimiter* limiteur = isBotMode && isLimiteMode ? new RateLimiter(botDebit, botRafale, botPolitique) : nullptr;
+        int fd_occupe = -1;          // Descripteur d'envoi des réponses "occupé", ouvert au besoin
+        bool occupeSignale = false;  // Une seule réponse "occupé" par période de surcharge
 
+        bool deconnexion = false; // L'autre utilisateur a annoncé son départ
+        bool affichageDemande = false; // FLUSH envoyé au parent, mémoire partagée pas encore vidée
         char buffer[256]; // Buffer pour la lecture des messages
         while (!should_exit) {
-            ssize_t bytesRead = safeReadMessage(fd_receive, buffer, sizeof(buffer));
+            // En mode manuel, un message de plus pourrait ne pas tenir dans la mémoire
+            // partagée : la réception est suspendue jusqu'à l'affichage par le parent,
+            // l'autre utilisateur étant bloqué par le pipe plein plutôt que des messages perdus
+            bool memoirePleine = isManuelMode && !sharedMemory->has_room(sizeof(buffer));
+            if (memoirePleine && !affichageDemande) {
+                affichageDemande = Pipes::sendControl(fd_ctrl_parent, TypeControle::FLUSH);
+            } else if (!memoirePleine) {
+                affichageDemande = false;
+            }
+
+            // Traiter les requêtes en file pour lesquelles un jeton est disponible
+            string requete;
+            while (limiteur && !memoirePleine && limiteur->nextReady(requete)) {
+                delivrer_message(requete.c_str(), sharedMemory);
+                occupeSignale = false;
+                memoirePleine = isManuelMode && !sharedMemory->has_room(sizeof(buffer));
+            }
+
+            // Le pipe de données est ignoré tant que la mémoire partagée est pleine,
+            // le pipe de contrôle une fois le départ de l'autre utilisateur annoncé ;
+            // si des messages sont déjà dans le buffer, on ne fait que vérifier le contrôle
+            bool messagesEnAttente = !memoirePleine && pipes.hasBufferedData();
+            struct pollfd fds[2] = {
+                {deconnexion ? -1 : fd_ctrl_receive, POLLIN, 0},
+                {memoirePleine ? -1 : fd_receive, POLLIN, 0},
+            };
+            int delai = messagesEnAttente ? 0 : (limiteur ? limiteur->pollTimeout() : -1);
+            if (memoirePleine) {
+                delai = SharedMemory::ATTENTE_AFFICHAGE_MS; // Le parent ne prévient pas quand il a vidé la mémoire
+            }
+            if (pipes.wait(fds, 2, delai) == -1) {
+                if (errno == EINTR) continue;
+                perror("Erreur lors de l'attente sur les pipes de réception");
+                break;
+            }
+
+            // Le canal de contrôle est toujours traité en priorité, quel que
+            // soit le nombre de messages en attente dans le pipe de données
+            if (fds[0].revents) {
+                TrameControle trame;
+                ssize_t n = pipes.receiveControl(fd_ctrl_receive, trame);
+                if (n <= 0 || trame.type == TypeControle::DISCONNECT) {
+                    // L'autre utilisateur a quitté : le parent cesse tout de suite
+                    // d'envoyer, quel que soit le nombre de messages en attente ;
+                    // ceux-ci (au plus la capacité du pipe, qu'il a fermé) sont
+                    // affichés avant de terminer sur la fin de flux comme d'habitude
+                    deconnexion = true;
+                    Pipes::sendControl(fd_ctrl_parent, TypeControle::DISCONNECT);
+                }
+                // HEARTBEAT ou type inconnu : la trame prouve seulement que l'autre est vivant
+                continue; // Vider le canal de contrôle avant de lire des données
+            }
+            if (!fds[1].revents && !messagesEnAttente) continue;
+
+            ssize_t bytesRead = pipes.receiveMessage(fd_receive, buffer, sizeof(buffer));
             if (bytesRead > 0) {
                 buffer[bytesRead] = '\0'; // Ajout du terminateur de chaîne
-                if (isManuelMode) {
-                    sharedMemory->write_to_shared_memory(string(buffer)); // Écriture dans la mémoire partagée
-                    // Émettre un bip sonore pour notifier l'arrivée d'un message
-                    printf("\a");
-                    fflush(stdout);
-                    // Vérifier si plus de 4096 octets sont en attente
-                    if (*shm_offset_ptr >= SharedMemory::SHM_SIZE - sizeof(size_t)) {
-                        // Envoyer SIGUSR1 au processus parent pour afficher les messages
-                        kill(getppid(), SIGUSR1);
-                    }
-                } else {
-                    // Affichage immédiat du message
-                    printf(texte_a_print(pseudo_destinataire).c_str(),
-                           pseudo_destinataire.c_str(), buffer);
-                    fflush(stdout);
+                if (!limiteur) {
+                    delivrer_message(buffer, sharedMemory);
+                    continue;
+                }
+                switch (limiteur->submit(buffer)) {
+                    case RateLimiter::Decision::ACCEPTEE:
+                        delivrer_message(buffer, sharedMemory);
+                        occupeSignale = false;
+                        break;
+                    case RateLimiter::Decision::OCCUPEE:
+                        if (!occupeSignale) {
+                            if (fd_occupe == -1) {
+                                // Non bloquant : sous surcharge, une réponse perdue vaut mieux qu'un blocage
+                                fd_occupe = open(sendPipe.c_str(), O_WRONLY | O_NONBLOCK);
+                            }
+                            // Écriture atomique (< PIPE_BUF), un échec est sans conséquence
+                            if (fd_occupe != -1 && write(fd_occupe, RateLimiter::MESSAGE_OCCUPE, strlen(RateLimiter::MESSAGE_OCCUPE) + 1) > 0) {
+                                occupeSignale = true;
+                            }
+                        }
+                        break;
+                    default:
+                        break; // En file, ignorée ou fusionnée
                 }
             } else if (bytesRead == 0) {
-                // Pipe fermé, l'autre utilisateur a quitté
-                if (!isManuelMode) {
-                    // Informer le processus parent en mode normal
-                    kill(getppid(), SIGUSR2);
+                // Pipe fermé, l'autre utilisateur a quitté sans l'annoncer
+                if (!deconnexion) {
+                    Pipes::sendControl(fd_ctrl_parent, TypeControle::DISCONNECT);
                 }
                 break;
             } else {
@@ -164,12 +312,23 @@ int main(int argc, char* argv[]) {
                 if (errno == EINTR) {
                     continue; // Continuer la lecture
                 } else {
-                    perror("Erreur lors de la lecture du pipe de réception");
-                    break;
+                    break; // Erreur déjà affichée par receiveMessage
                 }
             }
         }
+        pipes.release_io();
         close(fd_receive); // Fermeture du pipe de réception
+        close(fd_ctrl_receive); // Fermeture du pipe de contrôle de réception
+        if (fd_occupe != -1) close(fd_occupe);
+        if (fd_tui_send != -1) close(fd_tui_send);
+        close(fd_ctrl_parent);
+        if (limiteur) {
+            if (limiteur->occupees + limiteur->ignorees + limiteur->fusionnees > 0) {
+                limiteur->print_stats(stderr);
+            }
+            delete limiteur;
+            limiteur = nullptr;
+        }
         if (isManuelMode) {
             sharedMemory->release_shared_memory(false); // Libération de la mémoire partagée
             delete sharedMemory;
@@ -178,15 +337,21 @@ int main(int argc, char* argv[]) {
         exit(0);
     } else {
         // === Processus parent ===
+        if (fd_tui[1] != -1) close(fd_tui[1]);
+        int fd_tui_receive = fd_tui[0];
+        close(fd_interne[1]);
+        int fd_interne_receive = fd_interne[0];
 
         signal(SIGINT, SignalHandler::handleSIGINT);   // Gestionnaire pour SIGINT
         signal(SIGPIPE, SignalHandler::handleSIGPIPE); // Gestionnaire pour SIGPIPE
         signal(SIGUSR1, SignalHandler::handleSIGUSR1); // Gestionnaire pour SIGUSR1
-        signal(SIGUSR2, SignalHandler::handleSIGUSR2); // Gestionnaire pour SIGUSR2
+        signal(SIGWINCH, SignalHandler::handleSIGWINCH); // Gestionnaire pour SIGWINCH
+        signal(SIGALRM, SignalHandler::handleSIGALRM); // Signe de vie périodique
+        alarm(SessionRegistry::INTERVALLE_HEARTBEAT);
 
         // Configuration du terminal pour le mode joli
         struct termios oldt, newt;
-        if (isJoliMode) {
+        if (isJoliMode && fd_tui_receive == -1) {
             // Obtenir les attributs du terminal
             tcgetattr(STDIN_FILENO, &oldt);
             newt = oldt;
@@ -198,6 +363,11 @@ int main(int argc, char* argv[]) {
             tcsetattr(STDIN_FILENO, TCSANOW, &newt);
         }
 
+        // Le registre indique tout de suite si le destinataire est déjà là
+        if (!isBotMode && !pipes.peerConnected()) {
+            fprintf(stderr, "%s n'est pas connecté, en attente...\n", pseudo_destinataire.c_str());
+        }
+
         // Ouverture du pipe d'envoi
         fd_send = open(sendPipe.c_str(), O_WRONLY);
         if (fd_send < 0) {
@@ -211,17 +381,163 @@ int main(int argc, char* argv[]) {
             }
             exit(1);
         }
+        fd_ctrl_send = open(pipes.sendCtrlPipe.c_str(), O_WRONLY);
+        if (fd_ctrl_send < 0) {
+            perror("Erreur lors de l'ouverture du pipe de contrôle d'envoi");
+            kill(pid, SIGTERM);
+            if (isManuelMode) {
+                sharedMemory->release_shared_memory(true);
+                delete sharedMemory;
+                sharedMemory = nullptr;
+            }
+            exit(1);
+        }
         pipesOuverts = true;
 
+        // Passage en interface plein écran une fois la connexion établie
+        if (fd_tui_receive != -1) {
+            tui = new Tui();
+            if (tui->start()) {
+                atexit(restaurer_terminal); // Y compris sur exit() depuis un gestionnaire
+            } else {
+                delete tui;
+                tui = nullptr;
+                // Plus personne ne lit : l'enfant reviendra à l'affichage direct
+                close(fd_tui_receive);
+                fd_tui_receive = -1;
+            }
+        }
+
+        // Choix du backend d'entrées/sorties, propre à chaque processus ; l'interface
+        // plein écran garde read/write, l'enfant utilise io_uring dans tous les cas
+        if (!tui && !pipes.initialize_io(isUringMode) && isUringMode) {
+            fprintf(stderr, "\033[33mWARNING\033[0m io_uring indisponible, utilisation de read/write.\n");
+        }
+
+        bool continuer = true;
+        bool departDestinataire = false; // Fin de l'interface sur le départ de l'autre utilisateur
+        while (tui && continuer) {
+            // === Interface plein écran ===
+            if (tui_redimensionner) {
+                tui_redimensionner = 0;
+                tui->resize();
+            }
+            if (flush_demande) {
+                flush_demande = 0;
+                if (isManuelMode) {
+                    sharedMemory->output_shared_memory(); // Afficher les messages en attente
+                }
+            }
+            tui->render();
+
+            struct pollfd fds[3] = {
+                {STDIN_FILENO, POLLIN, 0},
+                {fd_tui_receive, POLLIN, 0},
+                {fd_interne_receive, POLLIN, 0},
+            };
+            if (poll(fds, 3, tui->pollTimeout()) == -1) {
+                if (errno == EINTR) continue;
+                perror("Erreur lors de l'attente de l'interface");
+                break;
+            }
+
+            if (fds[2].revents) {
+                continuer = traiter_controle_interne(fd_interne_receive, pipes, sharedMemory);
+                departDestinataire = !continuer;
+                continue;
+            }
+
+            if (fds[1].revents) {
+                // Messages reçus par le processus enfant : seulement ajoutés à
+                // l'historique, l'écran est redessiné au plus une fois par image
+                char message[256];
+                do {
+                    ssize_t n = pipes.receiveMessage(fd_tui_receive, message, sizeof(message));
+                    if (n <= 0) {
+                        close(fd_tui_receive);
+                        fd_tui_receive = -1; // Ignoré par poll()
+                        break;
+                    }
+                    tui->addMessage(pseudo_destinataire, message);
+                } while (pipes.hasBufferedData());
+            }
+
+            if (fds[0].revents) {
+                bool finSaisie = !tui->readInput();
+                string ligne;
+                while (continuer && tui->nextLine(ligne)) {
+                    continuer = envoyer_saisie(ligne.c_str(), pipes, sharedMemory);
+                }
+                if (continuer && finSaisie) {
+                    // Fin de la saisie (Ctrl+D)
+                    if (isManuelMode) {
+                        sharedMemory->output_shared_memory(); // Afficher les messages en attente
+                    }
+                    kill(pid, SIGTERM);
+                    continuer = false;
+                }
+            }
+        }
+        if (tui && departDestinataire) {
+            // Derniers messages transmis par l'enfant, qui ferme le pipe en se
+            // terminant, puis historique laissé à l'écran jusqu'à une touche
+            char message[256];
+            while (fd_tui_receive != -1) {
+                ssize_t n = pipes.receiveMessage(fd_tui_receive, message, sizeof(message));
+                if (n <= 0) {
+                    close(fd_tui_receive);
+                    fd_tui_receive = -1;
+                    break;
+                }
+                tui->addMessage(pseudo_destinataire, message);
+            }
+            tui->announce(pseudo_destinataire + " a quitté la conversation, appuyez sur une touche.");
+            tui->render(true);
+            char touche;
+            while (read(STDIN_FILENO, &touche, 1) == -1 && errno == EINTR) {
+                if (tui_redimensionner) {
+                    tui_redimensionner = 0;
+                    tui->resize();
+                    tui->render(true);
+                }
+            }
+        }
+        if (tui) {
+            tui->stop();
+            delete tui;
+            tui = nullptr;
+        }
+        if (fd_tui_receive != -1) close(fd_tui_receive);
+
+        // Saisie lue par blocs et découpée en lignes comme par fgets, pour
+        // attendre en même temps le canal de contrôle interne
+        char saisie[Pipes::IO_BUFFER_SIZE];
+        size_t debutSaisie = 0;
+        size_t finSaisie = 0;
+        bool finEntree = false;
+        bool inviteAffichee = false;
         char buffer[256]; // Buffer pour la lecture des messages de l'utilisateur
-        while (true) {
-            if (isJoliMode) {
+        while (continuer) {
+            if (flush_demande) {
+                flush_demande = 0;
+                if (isManuelMode) {
+                    sharedMemory->output_shared_memory(); // Afficher les messages en attente
+                    fflush(stdout);
+                }
+            }
+            if (isJoliMode && !inviteAffichee) {
                 // Afficher une phrase avant la saisie
                 printf("\n⭐✨ Veuillez entrer votre message ✨⭐ : \n");
                 fflush(stdout);
+                inviteAffichee = true;
             }
 
-            if (!fgets(buffer, sizeof(buffer), stdin)) {
+            if (extraire_ligne(saisie, debutSaisie, finSaisie, finEntree, buffer, sizeof(buffer))) {
+                inviteAffichee = false;
+                continuer = envoyer_saisie(buffer, pipes, sharedMemory);
+                continue;
+            }
+            if (finEntree) {
                 // Fin de stdin (Ctrl+D)
                 if (isManuelMode) {
                     sharedMemory->output_shared_memory(); // Afficher les messages en attente
@@ -231,35 +547,46 @@ int main(int argc, char* argv[]) {
                 break;
             }
 
-            if (strcmp(buffer, "exit\n") == 0) {
-                // Commande 'exit' reçue, terminer le chat
-                // Envoyer SIGTERM au processus enfant pour qu'il se termine
-                kill(pid, SIGTERM);
-                break;
-            }
-
-            size_t message_length = strlen(buffer) + 1;
-            if (safeWrite(fd_send, buffer, message_length) == -1) {
-                // Erreur lors de l'écriture, déjà affichée dans safeWrite
+            struct pollfd fds[2] = {
+                {STDIN_FILENO, POLLIN, 0},
+                {fd_interne_receive, POLLIN, 0},
+            };
+            if (pipes.wait(fds, 2, -1) == -1) {
+                if (errno == EINTR) continue; // Signal traité en début de boucle
+                perror("Erreur lors de l'attente de la saisie");
                 break;
             }
 
-            if (!isBotMode) {
-                // Affichage du message envoyé par l'utilisateur
-                printf(texte_a_print(pseudo_utilisateur).c_str(), pseudo_utilisateur.c_str(), buffer);
-                fflush(stdout);
+            // Le canal de contrôle interne passe avant la saisie
+            if (fds[1].revents) {
+                continuer = traiter_controle_interne(fd_interne_receive, pipes, sharedMemory);
+                continue;
             }
-
-            if (isManuelMode) {
-                sharedMemory->output_shared_memory(); // Afficher les messages en attente
+            if (fds[0].revents) {
+                ssize_t n = pipes.readData(STDIN_FILENO, saisie + finSaisie, sizeof(saisie) - finSaisie);
+                if (n > 0) {
+                    finSaisie += n;
+                } else if (n == 0 || errno != EINTR) {
+                    finEntree = true;
+                }
             }
         }
+        if (fd_interne_receive != -1) close(fd_interne_receive);
 
         // Rétablir les anciens attributs du terminal
-        if (isJoliMode) {
+        if (isJoliMode && fd_tui[0] == -1) {
             tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
         }
 
+        alarm(0); // Plus de signe de vie pendant la fermeture
+
+        pipes.release_io(); // Messages encore en vol écrits avant d'annoncer le départ
+
+        // Prévenir l'autre utilisateur sans attendre qu'il ait lu nos messages
+        // (sans effet s'il est déjà parti)
+        Pipes::sendControl(fd_ctrl_send, TypeControle::DISCONNECT);
+        close(fd_ctrl_send); // Fermeture du pipe de contrôle d'envoi
+        fd_ctrl_send = -1;
         close(fd_send); // Fermeture du pipe d'envoi
 
         // Attendre la fin du processus enfant
@@ -284,6 +611,13 @@ bool containsChar(const string& str, char ch) {
     return find(str.begin(), str.end(), ch) != str.end();
 }
 
+// Horloge monotone en secondes, commune à tous les processus (registre des sessions)
+double maintenant() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
 // Fonction pour obtenir le code couleur en fonction du pseudonyme
 string getColorCode(const string& pseudo) {
     // Calculer un hachage simple du pseudonyme
@@ -296,6 +630,112 @@ string getColorCode(const string& pseudo) {
     return color_codes[color_index];
 }
 
+// Fonction pour afficher ou mettre en attente un message reçu
+void delivrer_message(const char* message, SharedMemory* sharedMemory) {
+    if (isManuelMode) {
+        sharedMemory->write_to_shared_memory(string(message)); // Écriture dans la mémoire partagée
+        // Émettre un bip sonore pour notifier l'arrivée d'un message
+        printf("\a");
+        fflush(stdout);
+    } else if (fd_tui_send != -1) {
+        // Transmission à l'interface du processus parent (écriture atomique, < PIPE_BUF)
+        if (write(fd_tui_send, message, strlen(message) + 1) == -1) {
+            if (errno != EPIPE) {
+                perror("Erreur lors de la transmission du message à l'interface");
+            }
+            // Interface indisponible : affichage direct, pour ce message et les suivants
+            close(fd_tui_send);
+            fd_tui_send = -1;
+            printf(texte_a_print(pseudo_destinataire).c_str(),
+                   pseudo_destinataire.c_str(), message);
+            fflush(stdout);
+        }
+    } else {
+        // Affichage immédiat du message
+        printf(texte_a_print(pseudo_destinataire).c_str(),
+               pseudo_destinataire.c_str(), message);
+        fflush(stdout);
+    }
+}
+
+// Fonction pour traiter une trame du processus enfant, renvoie false si le chat doit se terminer
+bool traiter_controle_interne(int& fd_interne, Pipes& pipes, SharedMemory* sharedMemory) {
+    TrameControle trame;
+    if (pipes.receiveControl(fd_interne, trame) <= 0) {
+        // Processus enfant terminé : l'autre utilisateur est parti
+        close(fd_interne);
+        fd_interne = -1; // Ignoré par poll()
+        trame.type = TypeControle::DISCONNECT;
+    }
+
+    if (trame.type == TypeControle::FLUSH && isManuelMode) {
+        // Mémoire partagée pleine : le processus enfant attend l'affichage
+        sharedMemory->output_shared_memory();
+        fflush(stdout);
+    } else if (trame.type == TypeControle::DISCONNECT && !isManuelMode) {
+        // En mode normal, terminer le programme ; le processus enfant affiche
+        // encore les derniers messages reçus et se termine sur la fin de flux
+        return false;
+    }
+    // En mode manuel, ne pas terminer le programme
+    return true;
+}
+
+// Fonction pour découper la saisie en lignes comme fgets, renvoie false si aucune ligne n'est complète
+bool extraire_ligne(char* saisie, size_t& debut, size_t& fin, bool finEntree, char* ligne, size_t taille) {
+    size_t disponible = fin - debut;
+    const char* retour = static_cast<const char*>(memchr(saisie + debut, '\n', disponible));
+    size_t longueur = retour ? retour - (saisie + debut) + 1 : disponible;
+    if (longueur > taille - 1) {
+        longueur = taille - 1; // Ligne trop longue, découpée comme par fgets
+    } else if ((!retour && !finEntree) || longueur == 0) {
+        // Ligne incomplète : la ramener au début du buffer en attendant la suite
+        memmove(saisie, saisie + debut, disponible);
+        debut = 0;
+        fin = disponible;
+        return false;
+    }
+
+    memcpy(ligne, saisie + debut, longueur);
+    ligne[longueur] = '\0';
+    debut += longueur;
+    return true;
+}
+
+// Fonction pour envoyer une ligne saisie, renvoie false si le chat doit se terminer
+bool envoyer_saisie(const char* buffer, Pipes& pipes, SharedMemory* sharedMemory) {
+    if (strcmp(buffer, "exit\n") == 0) {
+        // Commande 'exit' reçue, terminer le chat
+        // Envoyer SIGTERM au processus enfant pour qu'il se termine
+        kill(pid, SIGTERM);
+        return false;
+    }
+
+    size_t message_length = strlen(buffer) + 1;
+    if (pipes.sendMessage(fd_send, buffer, message_length) == -1) {
+        // Erreur lors de l'écriture, déjà affichée dans sendMessage
+        return false;
+    }
+
+    if (tui) {
+        tui->addMessage(pseudo_utilisateur, buffer);
+    } else if (!isBotMode) {
+        // Affichage du message envoyé par l'utilisateur
+        printf(texte_a_print(pseudo_utilisateur).c_str(), pseudo_utilisateur.c_str(), buffer);
+        fflush(stdout);
+    }
+
+    if (isManuelMode) {
+        sharedMemory->output_shared_memory(); // Afficher les messages en attente
+    }
+    return true;
+}
+
+// Fonction pour quitter l'interface plein écran à la fin du programme
+void restaurer_terminal() {
+    if (tui) tui->stop();
+}
+
 string texte_a_print(string pseudo) {
     string texte;
     if (isBotMode) {
@@ -311,59 +751,3 @@ string texte_a_print(string pseudo) {
     }
     return texte;
 }
-
-ssize_t safeWrite(int fd, const void* buf, size_t count) {
-    size_t total_written = 0;
-    const char* buffer = static_cast<const char*>(buf);
-
-    while (total_written < count) {
-        ssize_t bytes_written = write(fd, buffer + total_written, count - total_written);
-        if (bytes_written == -1) {
-            if (errno == EINTR) {
-                continue; // Interruption par un signal, on réessaie
-            } else {
-                // Erreur critique
-                perror("Erreur lors de l'écriture dans le pipe");
-                return -1;
-            }
-        }
-        total_written += bytes_written;
-    }
-    return total_written;
-}
-
-ssize_t safeReadMessage(int fd, char* buffer, size_t max_size) {
-    size_t total_read = 0;
-    while (total_read < max_size - 1) { // On laisse de la place pour le '\0'
-        ssize_t bytes_read = read(fd, buffer + total_read, 1);
-        if (bytes_read == -1) {
-            if (errno == EINTR) {
-                continue; // Interruption par un signal, on réessaie
-            } else {
-                // Erreur critique
-                perror("Erreur lors de la lecture du pipe de réception");
-                return -1;
-            }
-        } else if (bytes_read == 0) {
-            // Fin du flux
-            if (total_read == 0) {
-                // Pas de données lues
-                return 0;
-            } else {
-                // Données partielles lues
-                buffer[total_read] = '\0'; // On termine la chaîne
-                return total_read;
-            }
-        } else {
-            // Un octet lu
-            if (buffer[total_read] == '\0') {
-                // Fin du message
-                return total_read + 1;
-            }
-            total_read += bytes_read;
-        }
-    }
-    // Si on arrive ici, le buffer est plein
-    buffer[total_read] = '\0'; // On termine la chaîne
-    return total_read;
-}